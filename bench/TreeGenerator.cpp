@@ -0,0 +1,169 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "TreeGenerator.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <ranges>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// SplitMix64: tiny, fast and identical everywhere.
+class Rng {
+public:
+    explicit Rng(const uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(const size_t bound) { return bound ? static_cast<size_t>(next() % bound) : 0; }
+
+private:
+    uint64_t state;
+};
+
+struct Dir {
+    std::string rel;
+    size_t depth = 0;
+    size_t parent = 0;
+    bool ignored = false;
+};
+
+// Names CodeCounter never descends into.
+const char* const kIgnoredNames[] = {"node_modules", "__pycache__", "venv", ".idea"};
+
+bool hashComments(const std::string_view ext) {
+    return ext == ".py" || ext == ".rb" || ext == ".sh";
+}
+
+void appendFile(std::string& out, const std::string_view ext, const size_t lines, Rng& rng) {
+    const bool prose = ext == ".md";
+    const bool hash = hashComments(ext);
+    const char* comment = hash ? "# " : "// ";
+    const char* end = hash || ext == ".go" ? "" : ";";
+
+    for (size_t i = 0; i < lines; ++i) {
+        const size_t kind = rng.below(10);
+        if (kind == 0) {
+            out += '\n';
+        } else if (prose) {
+            out += "Paragraph " + std::to_string(i) + " describes item " + std::to_string(rng.below(1000)) + ".\n";
+        } else if (kind == 1 && !hash && i + 3 <= lines && rng.below(4) == 0) {
+            out += "/*\n * Block comment " + std::to_string(i) + "\n */\n";
+            i += 2;
+        } else if (kind == 1) {
+            out += std::string(comment) + "note " + std::to_string(rng.below(1000)) + " about this step\n";
+        } else {
+            out += std::string(4 * (1 + rng.below(3)), ' ') + "total += item" + std::to_string(rng.below(100))
+                 + " * " + std::to_string(rng.below(10)) + end + '\n';
+        }
+    }
+}
+
+}
+
+bool TreeShape::parseMix(const std::string& spec) {
+    std::vector<std::pair<std::string, unsigned>> parsed;
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        const std::string item = spec.substr(pos, comma - pos);
+        pos = comma + 1;
+
+        const size_t eq = item.find('=');
+        if (eq == 0 || eq == std::string::npos) return false;
+        try {
+            const unsigned long weight = std::stoul(item.substr(eq + 1));
+            if (weight == 0) return false;
+            parsed.emplace_back('.' + item.substr(0, eq), static_cast<unsigned>(weight));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (parsed.empty()) return false;
+    mix = std::move(parsed);
+    return true;
+}
+
+bool generateTree(const std::string& root, const TreeShape& shape, GeneratedTree& tree) {
+    std::error_code ec;
+    if (fs::exists(root, ec)) {
+        std::cerr << root << " already exists\n";
+        return false;
+    }
+
+    Rng rng(shape.seed);
+
+    // Each new directory hangs off a random earlier one that still has room
+    // below it, which gives a bushy tree with a long tail of deep paths.
+    const size_t dirCount = shape.depth == 0 ? 1 : std::max<size_t>(1, shape.files / std::max<size_t>(1, shape.filesPerDir));
+    std::vector<Dir> dirs = {{"", 0, 0, false}};
+    std::unordered_set<std::string> taken;
+    for (size_t i = 1; i < dirCount; ++i) {
+        size_t parent = rng.below(i);
+        while (dirs[parent].depth >= shape.depth) parent = dirs[parent].parent;
+
+        const bool ignored = rng.below(100) < shape.ignoredPercent;
+        std::string name = ignored ? kIgnoredNames[rng.below(std::size(kIgnoredNames))] : "d" + std::to_string(i);
+        std::string rel = dirs[parent].rel.empty() ? name : dirs[parent].rel + '/' + name;
+        if (!taken.insert(rel).second) {
+            name = "cmake-build-" + std::to_string(i);
+            rel = dirs[parent].rel.empty() ? name : dirs[parent].rel + '/' + name;
+            taken.insert(rel);
+        }
+        dirs.push_back({std::move(rel), dirs[parent].depth + 1, parent, ignored || dirs[parent].ignored});
+    }
+
+    for (const auto& dir : dirs) {
+        if (!fs::create_directories(fs::path(root) / dir.rel, ec) && ec) {
+            std::cerr << "cannot create " << root << '/' << dir.rel << ": " << ec.message() << '\n';
+            return false;
+        }
+    }
+
+    unsigned totalWeight = 0;
+    for (const auto& weight : shape.mix | std::views::values) totalWeight += weight;
+
+    std::string content;
+    tree.files.reserve(shape.files);
+    tree.ignored.reserve(shape.files);
+    for (size_t i = 0; i < shape.files; ++i) {
+        const Dir& dir = dirs[rng.below(dirs.size())];
+
+        size_t pick = rng.below(totalWeight);
+        size_t lang = 0;
+        while (pick >= shape.mix[lang].second) pick -= shape.mix[lang++].second;
+        const std::string& ext = shape.mix[lang].first;
+
+        size_t lines = 1 + rng.below(2 * shape.meanLines);
+        if (rng.below(100) < shape.largePercent) lines *= 20;
+
+        content.clear();
+        appendFile(content, ext, lines, rng);
+
+        std::string rel = (dir.rel.empty() ? "" : dir.rel + '/') + "f" + std::to_string(i) + ext;
+        std::ofstream out(fs::path(root) / rel, std::ios::binary);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!out) {
+            std::cerr << "cannot write " << root << '/' << rel << '\n';
+            return false;
+        }
+
+        if (dir.ignored) ++tree.ignoredFiles;
+        else tree.bytes += content.size();
+        tree.files.push_back(std::move(rel));
+        tree.ignored.push_back(dir.ignored);
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Shape of a synthetic source tree. The same shape and seed always produce
+// the same tree, byte for byte, on every platform: the generator uses its own
+// integer RNG instead of <random>, whose distributions are not portable.
+struct TreeShape {
+    size_t files = 20000;
+    size_t depth = 6;            // deepest directory level below the root
+    size_t filesPerDir = 16;     // average files per directory
+    size_t meanLines = 200;      // file length is uniform in [1, 2 * meanLines]...
+    size_t largePercent = 2;     // ...except this share, which is 20x longer
+    size_t ignoredPercent = 10;  // share of directories named like build / vendor trees
+    uint64_t seed = 1;
+    // Extension and relative weight of each language.
+    std::vector<std::pair<std::string, unsigned>> mix = {
+        {".cpp", 4}, {".h", 3}, {".py", 2}, {".js", 2}, {".go", 1}, {".rs", 1}, {".md", 1}
+    };
+
+    // Parses "cpp=4,h=3,py=2" into `mix`.
+    bool parseMix(const std::string& spec);
+};
+
+struct GeneratedTree {
+    std::vector<std::string> files;  // relative paths, every file written
+    std::vector<bool> ignored;       // file lies under an ignored directory
+    size_t bytes = 0;                // size of the files outside ignored directories
+    size_t ignoredFiles = 0;
+};
+
+// Writes the tree below `root`, which must not exist yet.
+[[nodiscard]] bool generateTree(const std::string& root, const TreeShape& shape, GeneratedTree& tree);
@@ -0,0 +1,239 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+// cliutils_bench: generates a synthetic source tree and times the CodeCounter
+// building blocks on it. Prints one JSON document to stdout, so runs can be
+// stored and compared over time.
+//
+//   cliutils_bench [--files N] [--depth N] [--dir-files N] [--mean-lines N]
+//                  [--large PCT] [--ignored PCT] [--mix cpp=4,h=3,py=2]
+//                  [--seed N] [--repeat N] [--root DIR] [--keep]
+//                  [CodeCounter options, e.g. --threads 4 --no-uring]
+
+#include "CodeCounter.h"
+#include "LineLexer.h"
+#include "TreeGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Result {
+    std::string name;
+    double seconds = 0;
+    size_t items = 0;
+    size_t bytes = 0;       // 0 when the benchmark does not read content
+    size_t lines = 0;
+    long peakRssKb = 0;     // process high-water mark after this case, earlier cases included
+    long rssGrowthKb = 0;   // how far this case raised it
+};
+
+// ru_maxrss is in kilobytes on Linux and in bytes on macOS.
+long peakRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+// Best of `repeat` runs; `run` returns the number of items it processed.
+template <typename Run>
+Result measure(const std::string& name, const size_t repeat, const size_t bytes, Run&& run) {
+    Result result{name};
+    const long peakBefore = peakRssKb();
+    result.seconds = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < std::max<size_t>(1, repeat); ++i) {
+        const auto started = std::chrono::steady_clock::now();
+        result.items = run(result);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        result.seconds = std::min(result.seconds, elapsed.count());
+    }
+    result.bytes = bytes;
+    result.peakRssKb = peakRssKb();
+    result.rssGrowthKb = result.peakRssKb - peakBefore;
+    return result;
+}
+
+bool readNumber(const std::vector<std::string>& args, size_t& i, size_t& out) {
+    if (i + 1 >= args.size()) return false;
+    try {
+        out = std::stoul(args[++i]);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::string quoted(const std::string& s) {
+    std::ostringstream out;
+    out << std::quoted(s);
+    return out.str();
+}
+
+void printJson(const TreeShape& shape, const std::string& root, const GeneratedTree& tree,
+               const std::vector<Result>& results) {
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "{\n";
+    std::cout << "  \"shape\": {\"files\": " << shape.files << ", \"depth\": " << shape.depth
+              << ", \"dir_files\": " << shape.filesPerDir << ", \"mean_lines\": " << shape.meanLines
+              << ", \"large_percent\": " << shape.largePercent << ", \"ignored_percent\": " << shape.ignoredPercent
+              << ", \"seed\": " << shape.seed << ", \"mix\": {";
+    for (size_t i = 0; i < shape.mix.size(); ++i) {
+        std::cout << (i ? ", " : "") << quoted(shape.mix[i].first.substr(1)) << ": " << shape.mix[i].second;
+    }
+    std::cout << "}},\n";
+    std::cout << "  \"tree\": {\"root\": " << quoted(root) << ", \"files\": " << tree.files.size()
+              << ", \"ignored_files\": " << tree.ignoredFiles << ", \"bytes\": " << tree.bytes << "},\n";
+    std::cout << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const double seconds = std::max(r.seconds, 1e-9);
+        std::cout << "    {\"name\": " << quoted(r.name) << ", \"seconds\": " << std::setprecision(6) << r.seconds
+                  << std::setprecision(1) << ", \"files\": " << r.items
+                  << ", \"files_per_s\": " << static_cast<double>(r.items) / seconds;
+        if (r.bytes) std::cout << ", \"mb_per_s\": " << static_cast<double>(r.bytes) / seconds / 1e6;
+        else std::cout << ", \"mb_per_s\": null";
+        if (r.lines) std::cout << ", \"lines\": " << r.lines;
+        std::cout << ", \"process_peak_rss_kb\": " << r.peakRssKb << ", \"peak_rss_growth_kb\": " << r.rssGrowthKb
+                  << '}' << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    std::cout << "  ]\n}\n";
+}
+
+}
+
+int main(const int argc, char** argv) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    TreeShape shape;
+    size_t repeat = 3;
+    bool keep = false;
+    std::string root;
+    std::vector<std::string> counterArgs = {"--no-cache"};
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& option = args[i];
+        bool ok = true;
+        size_t seed = 0;
+        if (args[i] == "--files") ok = readNumber(args, i, shape.files);
+        else if (args[i] == "--depth") ok = readNumber(args, i, shape.depth);
+        else if (args[i] == "--dir-files") ok = readNumber(args, i, shape.filesPerDir);
+        else if (args[i] == "--mean-lines") ok = readNumber(args, i, shape.meanLines);
+        else if (args[i] == "--large") ok = readNumber(args, i, shape.largePercent);
+        else if (args[i] == "--ignored") ok = readNumber(args, i, shape.ignoredPercent);
+        else if (args[i] == "--repeat") ok = readNumber(args, i, repeat);
+        else if (args[i] == "--seed") {
+            ok = readNumber(args, i, seed);
+            shape.seed = seed;
+        }
+        else if (args[i] == "--mix") ok = i + 1 < args.size() && shape.parseMix(args[++i]);
+        else if (args[i] == "--root" && i + 1 < args.size()) root = args[++i];
+        else if (args[i] == "--keep") keep = true;
+        else counterArgs.push_back(args[i]);
+
+        if (!ok) {
+            std::cerr << "Bad value for " << option << '\n';
+            return 2;
+        }
+    }
+
+    CodeCounter counter;
+    if (!counter.parseArgs(counterArgs)) return 2;
+
+    if (root.empty()) {
+        root = (fs::temp_directory_path() / ("cliutils-bench-" + std::to_string(getpid()))).string();
+    }
+
+    GeneratedTree tree;
+    std::cerr << "Generating " << shape.files << " files in " << root << "...\n";
+    if (!generateTree(root, shape, tree)) return 1;
+
+    std::vector<std::string> counted;
+    for (size_t i = 0; i < tree.files.size(); ++i) {
+        if (!tree.ignored[i]) counted.push_back(root + '/' + tree.files[i]);
+    }
+
+    std::vector<Result> results;
+
+    // Single-threaded read + newline count of every file outside ignored trees.
+    results.push_back(measure("countLine", repeat, tree.bytes, [&](Result& r) {
+        r.lines = 0;
+        for (const auto& path : counted) r.lines += CodeCounter::countLine(path);
+        return counted.size();
+    }));
+
+    // Single-threaded code/comment/blank split over the same files, already
+    // in memory, so MB/s is the lexer alone (target: 1 GB/s per core).
+    std::vector<std::pair<LangId, std::string>> sources;
+    size_t sourceBytes = 0;
+    for (const auto& path : counted) {
+        const LangId lang = builtinLangOf(fs::path(path).extension().string());
+        if (lang == kNoLang) continue;
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream content;
+        content << in.rdbuf();
+        sources.emplace_back(lang, std::move(content).str());
+        sourceBytes += sources.back().second.size();
+    }
+    results.push_back(measure("classify", repeat, sourceBytes, [&](Result& r) {
+        r.lines = 0;
+        for (const auto& [lang, content] : sources) {
+            r.lines += LineLexer::classify(kBuiltinLangs[lang].syntax, content).lines;
+        }
+        return sources.size();
+    }));
+    sources = {};
+
+    // Path filter alone, on the relative paths of every generated file.
+    std::vector<fs::path> paths(tree.files.begin(), tree.files.end());
+    const size_t rounds = std::max<size_t>(1, 1'000'000 / std::max<size_t>(1, paths.size()));
+    results.push_back(measure("isIgnorePath", repeat, 0, [&](Result&) {
+        size_t ignored = 0;
+        for (size_t round = 0; round < rounds; ++round) {
+            for (const auto& path : paths) ignored += CodeCounter::isIgnorePath(path);
+        }
+        if (ignored != rounds * tree.ignoredFiles) std::cerr << "isIgnorePath disagrees with the generator\n";
+        return rounds * paths.size();
+    }));
+
+    // Directory walk with ignore rules, no file content.
+    results.push_back(measure("walk", repeat, 0, [&](Result&) {
+        std::atomic<size_t> files = 0;
+        counter.scanFiles(root, [&](size_t, const fs::path&) { files.fetch_add(1, std::memory_order_relaxed); });
+        return files.load();
+    }));
+
+    // What command 2 does, minus printing. MB/s is over every file the walk
+    // visits, including the ones no language claims.
+    results.push_back(measure("getLangStats", repeat, tree.bytes, [&](Result& r) {
+        const CodeCounter::LangReport report = counter.langReport(root);
+        size_t files = report.skipped.total();
+        r.lines = 0;
+        for (size_t lang = 0; lang < report.counts.size(); ++lang) {
+            files += report.counts[lang];
+            r.lines += report.totalsByLang[lang].lines;
+        }
+        return files;
+    }));
+
+    printJson(shape, root, tree, results);
+
+    if (!keep) {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+    return 0;
+}
@@ -3,7 +3,11 @@
 //
 
 #pragma once
+#include "CacheCatalog.h"
+#include "DirListing.h"
 #include "ICleaner.h"
+#include "TreeRemover.h"
+#include "WorkStealingPool.h"
 #include <map>
 
 class Cleaner final : public ICleaner {
@@ -13,12 +17,29 @@ public:
     std::string getStats(const std::string& path) const override;
     void removeFile() override;
     void largeDirectory() override;
+    void duplicateFiles() override;
+    void cacheReport() override;
+    void freeSpace() override;
+    [[nodiscard]] int exitCode() const override { return status; }
 
 private:
-    std::map<std::string, std::map<std::string, std::string>> allEntries;
-    std::map<std::string, std::map<std::string, std::string>> removeEntries;
-    [[nodiscard]] static std::string getFolder();
-    [[nodiscard]] static std::string resolveFolderPath(const std::string& key);
+    size_t threads = defaultThreadCount();
+    bool rescan = false;
+    std::string rulesFile;
+    uint64_t freeTarget = 0;
+    std::string freeKeys;
+    bool assumeYes = false;
+    bool dryRun = false;
+    int status = 0;
+    CacheCatalog catalog;
+    // One listing per folder, filled by getAllInfo and re-read before deleting.
+    std::map<std::string, DirListing> listings;
+    bool parseArgs(const std::vector<std::string>& args);
+    [[nodiscard]] std::string getFolder() const;
+    [[nodiscard]] std::string resolveFolderPath(const std::string& key) const;
     static bool confirmation(const std::string& text);
     void printFileInFolder(const std::string& folder);
+    // True when the plan reaches `target` and, unless dry-running, all of it was deleted.
+    bool evict(uint64_t target, const std::string& keys);
+    void removeWithProgress(TreeRemover& remover, const std::string& path, uint64_t expectedBytes) const;
 };
\ No newline at end of file
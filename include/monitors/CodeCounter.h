@@ -5,20 +5,77 @@
 #pragma once
 #include "Structs.h"
 #include "ICodeCounter.h"
+#include "WorkStealingPool.h"
+#include "LineCache.h"
+#include "LangTable.h"
+#include "IgnoreRules.h"
+#include "TopFiles.h"
+#include "Snapshot.h"
 #include <filesystem>
-#include <map>
+#include <functional>
 
 class CodeCounter final : public ICodeCounter {
 public:
+    CodeCounter();
     void execute(const std::vector<std::string>& args) override;
     void getFolderStats() const override;
     void getLangStats() override;
+    void getDirStats() const;
+    void watchTree(const std::string& folderPath) const;
+    void saveSnapshot(const std::string& folderPath, const std::string& file) const;
+    void diffTrees(const std::string& before, const std::string& after) const;
+
+    // Non-interactive pieces of the commands above, for the benchmark.
+    struct LangReport {
+        std::vector<std::vector<FileStats>> filesByLang;  // sorted, or the --top N per language
+        std::vector<size_t> counts;                       // files per language
+        std::vector<LineStats> totalsByLang;
+        SkippedFiles skipped;
+    };
+    bool parseArgs(const std::vector<std::string>& args);
+    [[nodiscard]] LangReport langReport(const std::string& folderPath) const;
+    using FileVisitor = std::function<void(size_t worker, const std::filesystem::path& path)>;
+    // The git index when there is one and --no-git is not set, else a walk.
+    void scanFiles(const std::string& folderPath, const FileVisitor& onFile, bool gitIndex = true) const;
+    [[nodiscard]] static size_t countLine(const std::string& folderPath);
+    [[nodiscard]] static bool isIgnorePath(const std::filesystem::path& path);
 
 private:
-    std::map<std::string, LangConfig> languageMap;
+    LangTable languages;
+    LangTable configuredLanguages;      // built-ins plus the config file, before any --lang
+    size_t threads = defaultThreadCount();
+    bool useCache = true;
+    bool useIgnoreFiles = true;
+    bool useGitIndex = true;
+    bool useUring = true;
+    bool allFiles = false;
+    size_t topFiles = 0;
+    size_t dirDepth = 2;
+    std::string watchFolder;
+    std::string snapshotFolder;
+    std::string snapshotFile;
+    std::string diffBefore;
+    std::string diffAfter;
+    std::vector<std::string> ignoreFiles;
 
-    void initMap();
+    void walkTree(const std::string& folderPath, const FileVisitor& onFile) const;
+    bool walkGitIndex(const std::string& folderPath, const FileVisitor& onFile) const;
     [[nodiscard]] static std::string inputFolder();
-    [[nodiscard]] static size_t countLine(const std::string& folderPath);
-    [[nodiscard]] static bool isIgnorePath(const std::filesystem::path& path);
+    using LangPicker = std::function<LangId(const std::filesystem::path& path)>;
+    // `hash` is the file's contentHash(), 0 unless countFiles was asked to hash.
+    using StatsVisitor = std::function<void(size_t worker, std::string_view path, const LineStats& stats, uint64_t hash)>;
+    // Returns one record per file for the caller to save(), so with a cache
+    // memory grows with the file count even when onStats keeps nothing; the
+    // same goes for `gitIndex`, which loads every tracked path first.
+    [[nodiscard]] std::vector<CacheRecord> countFiles(const std::string& folderPath, const LangPicker& pick,
+                                                      const LineCache* cache, const StatsVisitor& onStats,
+                                                      SkippedFiles& skipped, bool hashContent = false,
+                                                      bool gitIndex = true) const;
+    void countArchive(const std::string& archivePath, const LangPicker& pick,
+                      const StatsVisitor& onStats, SkippedFiles& skipped) const;
+    [[nodiscard]] std::vector<SnapshotEntry> snapshotEntries(const std::string& folderPath) const;
+    [[nodiscard]] std::vector<std::string> languageNames() const;
+    [[nodiscard]] std::unique_ptr<LineCache> openCache(const std::string& folderPath) const;
+    [[nodiscard]] std::shared_ptr<const IgnoreNode> rootIgnore(const std::string& folderPath) const;
+    [[nodiscard]] static bool isIgnoredName(std::string_view name);
 };
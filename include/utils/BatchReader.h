@@ -0,0 +1,39 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads many small files with few syscalls. On Linux the open, read and close
+// of up to a few dozen files go to io_uring in one submission, into buffers
+// registered with the kernel, and each file is handed to `consume` as soon as
+// its read completes while the others are still in flight. Without io_uring
+// (other systems, old kernels, seccomp) every file goes through readFile().
+//
+// Either way `consume` sees exactly the bytes readFile() would: files that do
+// not fit a ring buffer, or whose ring read fails, are re-read with readFile().
+// One reader must only be used by one thread at a time.
+class BatchReader {
+public:
+    using Consumer = std::function<void(size_t index, std::string_view content)>;
+
+    explicit BatchReader(bool useUring = true);
+    ~BatchReader();
+    BatchReader(BatchReader&&) noexcept;
+    BatchReader& operator=(BatchReader&&) noexcept;
+
+    [[nodiscard]] bool usesUring() const;
+
+    // Calls consume(i, content) for every paths[i] that could be read, in no
+    // particular order.
+    void read(const std::vector<std::string>& paths, const Consumer& consume);
+
+private:
+    struct Ring;
+    std::unique_ptr<Ring> ring;
+};
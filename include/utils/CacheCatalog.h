@@ -0,0 +1,106 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/stat.h>
+
+// One line of the rule file:
+//
+//     key  glob [glob...]  [age=30d]  [min=500M]
+//
+// Globs start at "~/" or "/" and may use *, ?, [...] in any path segment
+// ("\ " for a space). Every path they match is one cache entry. age= is how
+// long an entry must have gone unused (newest atime or mtime inside it)
+// before it counts as reclaimable, in s, m, h, d or w; min= drops the target
+// from the report while less than that is reclaimable. A key that appears
+// again gets the globs appended and the limits replaced.
+struct CacheRule {
+    std::string key;
+    std::vector<std::string> globs;
+    int64_t minAge = 0;         // seconds
+    uint64_t minSize = 0;       // bytes
+};
+
+struct CacheEntry {
+    std::string path;
+    uint64_t bytes = 0;         // apparent
+    uint64_t allocated = 0;     // st_blocks * 512
+    uint64_t files = 0;
+    int64_t lastUsed = 0;       // newest atime / mtime in the tree, seconds
+};
+
+struct CacheReport {
+    size_t rule = 0;            // index into CacheCatalog::rules()
+    std::vector<CacheEntry> entries;
+    uint64_t allocated = 0;
+    uint64_t reclaimable = 0;   // allocated by entries older than minAge
+    size_t unreadable = 0;
+};
+
+// "20G", "512M", "1.5T", "4096" (bytes); binary units. false on anything else.
+bool parseSize(std::string_view text, uint64_t& bytes);
+// "30d", "12h", "90m", "2w", "45s"; a bare number is days.
+bool parseAge(std::string_view text, int64_t& seconds);
+
+// Newest of atime and mtime, in seconds.
+[[nodiscard]] int64_t lastUse(const struct stat& st);
+
+// visit(dir, name, st) for everything below `root`, depth first, lstat'ed:
+// symlinks are reported, never followed. `dir` ends in '/'. Returns how many
+// directories could not be listed.
+using TreeVisitor = std::function<void(const std::string& dir, std::string_view name, const struct stat& st)>;
+size_t walkTree(const std::string& root, const TreeVisitor& visit);
+
+// The cache targets Cleaner knows about: built-in defaults for this platform
+// (macOS: ~/Library caches, Xcode, Safari; Linux: ~/.cache and the usual
+// build and package caches), or the rule file when there is one.
+class CacheCatalog {
+public:
+    CacheCatalog();
+
+    bool addRule(std::string_view line);
+    // Back to the built-in rules only.
+    void useDefaults();
+    // Replaces the built-in rules. A missing file keeps them, and is an error
+    // only with `mustExist`.
+    bool loadFile(const std::string& path, bool mustExist = false);
+    static std::string defaultConfigPath();
+
+    [[nodiscard]] const std::vector<CacheRule>& rules() const { return targets; }
+    [[nodiscard]] const std::string& source() const { return loadedFrom; }
+    // The folder a rule lists: its first glob without a trailing "/*", with
+    // "~" expanded and a trailing '/'. Empty when that still has wildcards.
+    [[nodiscard]] std::string folderOf(size_t rule) const;
+    [[nodiscard]] size_t find(std::string_view key) const;
+
+    // One task per target on a work-stealing pool, on the entries claim()
+    // hands out: a path matched by several targets counts once, for the
+    // first of them. Reports come back with
+    // the most reclaimable first; targets that matched nothing are left out.
+    [[nodiscard]] std::vector<CacheReport> scan(size_t threads);
+
+    // Every path the globs of `rule` match now, in byte order.
+    [[nodiscard]] std::vector<std::string> expand(size_t rule) const;
+    // expand() for every rule, a path going to the first rule that matches it.
+    // A path inside one already claimed is dropped: that entry's walk counts
+    // it. The reverse is not caught, an entry around an earlier one is walked
+    // whole, so specific rules go before the folders that hold them.
+    [[nodiscard]] std::vector<std::vector<std::string>> claim() const;
+
+    // Safe to read from another thread while scan() runs.
+    [[nodiscard]] size_t targetsScanned() const { return scanned.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesScanned() const { return seen.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<CacheRule> targets;
+    std::string loadedFrom;
+    std::atomic<size_t> scanned{0};
+    std::atomic<uint64_t> seen{0};
+};
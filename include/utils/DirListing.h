@@ -0,0 +1,51 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ListedEntry {
+    enum class Kind : uint8_t { File, Dir, Other, Unreadable };
+
+    uint64_t size = 0;
+    int64_t mtime = 0;          // seconds since the epoch
+    uint32_t nameOffset = 0;    // into the listing's name buffer
+    uint16_t nameSize = 0;
+    Kind kind = Kind::Unreadable;
+};
+
+// The entries of one directory, one stat each, kept as plain numbers: names
+// share one buffer and nothing is formatted until a row is shown, so a cache
+// folder with a few hundred thousand entries costs a few MB and sorts fast.
+class DirListing {
+public:
+    enum class Order { Name, Size, Age };
+
+    // Replaces the listing. Entries are stat'ed through symlinks, like stat().
+    bool read(const std::string& folder);
+    // Name: byte order; Size: largest first; Age: oldest first.
+    void sort(Order by);
+    // Drops entry `i`; its name stays in the buffer until the next read().
+    void erase(size_t i);
+
+    [[nodiscard]] size_t size() const { return entries.size(); }
+    [[nodiscard]] bool empty() const { return entries.empty(); }
+    [[nodiscard]] Order order() const { return current; }
+    [[nodiscard]] const ListedEntry& operator[](const size_t i) const { return entries[i]; }
+    [[nodiscard]] std::string_view name(const size_t i) const { return nameOf(entries[i]); }
+    [[nodiscard]] uint64_t totalSize() const { return total; }
+
+private:
+    std::vector<ListedEntry> entries;
+    std::string names;
+    uint64_t total = 0;
+    Order current = Order::Name;
+
+    [[nodiscard]] std::string_view nameOf(const ListedEntry& entry) const {
+        return {names.data() + entry.nameOffset, entry.nameSize};
+    }
+};
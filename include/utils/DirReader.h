@@ -0,0 +1,71 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// Lists a directory through its own fd instead of a path: getdents64 into a
+// 64 KiB buffer on Linux (fdopendir / readdir elsewhere). Children are opened
+// and stat'ed relative to that fd, so the kernel never walks the full path
+// again and callers only build path strings for what they report.
+//
+// Names are views into the listing buffer, NUL-terminated (they can go
+// straight to the *at() calls), and valid until the next call to next() or
+// open(). A reader can be reopened on another directory; the buffer is kept.
+class DirReader {
+public:
+    struct Entry {
+        std::string_view name;
+        unsigned char type;     // DT_*, DT_UNKNOWN when the filesystem does not say
+    };
+
+    DirReader() = default;
+    ~DirReader();
+    DirReader(DirReader&& other) noexcept;
+    DirReader& operator=(DirReader&& other) noexcept;
+    DirReader(const DirReader&) = delete;
+    DirReader& operator=(const DirReader&) = delete;
+
+    // Follows a symlink given as `path`, never one met as `name`.
+    bool open(const char* path);
+    // `name` must be NUL-terminated.
+    bool openAt(int parentFd, const char* name);
+    // Takes ownership of an fd opened with O_DIRECTORY.
+    bool adopt(int fd);
+    void close();
+
+    // Skips "." and "..". Returns false at the end or on a read error.
+    bool next(Entry& entry);
+
+    [[nodiscard]] int fd() const { return dirFd; }
+    // The listing stopped early because of an error.
+    [[nodiscard]] bool failed() const { return readError; }
+
+private:
+    int dirFd = -1;
+    bool readError = false;
+#if defined(__linux__)
+    std::unique_ptr<char[]> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+#else
+    DIR* dir = nullptr;
+#endif
+
+    bool attach(int fd);
+};
+
+// lstat() of `name` relative to `dirFd`.
+bool statAt(int dirFd, const char* name, struct stat& st);
+
+// d_type of `name`, asking fstatat only when the listing did not know it.
+unsigned char entryType(int dirFd, const DirReader::Entry& entry);
+
+// How many directory fds a parallel walk may keep queued: a quarter of
+// RLIMIT_NOFILE, within [16, 1024]. Past it, walkers reopen by path.
+size_t descriptorBudget();
@@ -0,0 +1,53 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Directories of one scan interned as nodes of a flat vector, each pointing
+// at its parent. Every ancestor is interned before its children, so a child
+// always has a larger id than its parent and a single backwards pass over the
+// ids is a post-order walk.
+//
+// Each node carries `width` counters (lines per language). Workers collect
+// counters for the directory they are in and add them with one locked call
+// when they move on; rollUp() then pushes every node's sums into its parent.
+class DirTree {
+public:
+    static constexpr uint32_t kRoot = 0;
+
+    struct Node {
+        uint32_t parent;
+        uint32_t depth;
+        std::string name;
+        size_t files = 0;
+    };
+
+    explicit DirTree(size_t width);
+
+    // relDir is relative to the scanned root, '/'-separated, "" for the root.
+    uint32_t intern(std::string_view relDir);
+    void add(uint32_t node, size_t files, const std::vector<size_t>& counters);
+
+    // Call once after the scan; afterwards counters include all descendants.
+    void rollUp();
+
+    [[nodiscard]] size_t size() const { return nodes.size(); }
+    [[nodiscard]] const Node& operator[](const uint32_t id) const { return nodes[id]; }
+    [[nodiscard]] const size_t* counters(const uint32_t id) const { return sums.data() + id * width; }
+    [[nodiscard]] size_t total(uint32_t id) const;
+    [[nodiscard]] std::vector<std::vector<uint32_t>> children() const;
+
+private:
+    size_t width;
+    std::mutex mutex;
+    std::vector<Node> nodes;
+    std::vector<size_t> sums;
+    std::unordered_map<std::string, uint32_t> ids;
+};
@@ -0,0 +1,115 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "DirReader.h"
+#include "WorkStealingPool.h"
+#include <cerrno>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// The parallel directory walk shared by DiskUsage and TreeRemover: one task
+// per directory on a work-stealing pool, each task holding the fd its parent
+// opened for it so the child is listed without resolving its path again.
+// Open fds are capped at descriptorBudget(); tasks queued past it carry -1
+// and are reopened from the root when they run, never through a symlink.
+//
+// Node is the caller's per-directory record and needs at least
+//     Node* parent; std::string name; std::atomic<uint32_t> pending;
+// Nodes live in per-worker arenas (deques, so they never move) that only
+// their worker appends to; they stay valid until the walk is destroyed.
+template <typename Node>
+class DirWalk {
+public:
+    struct Task {
+        Node* node = nullptr;
+        int fd = -1;    // -1: over the fd budget, open by path
+    };
+
+    DirWalk(const std::string& root, const size_t threads)
+        : root(root), pool(threads), arenas(pool.size()), fdBudget(descriptorBudget()) {}
+
+    [[nodiscard]] size_t size() const { return pool.size(); }
+    [[nodiscard]] std::vector<std::deque<Node>>& nodes() { return arenas; }
+
+    // visit(worker, node, fd) for `top` (already open as `topFd`) and every
+    // directory queued from inside a visit. Returns once all of them ran.
+    template <typename Visit>
+    void run(Node& top, const int topFd, Visit&& visit) {
+        queuedFds = 1;
+        pool.run({Task{&top, topFd}}, [&](const size_t worker, const Task& task) {
+            if (task.fd >= 0) queuedFds.fetch_sub(1, std::memory_order_relaxed);
+            visit(worker, task.node, task.fd);
+        });
+    }
+
+    // Lists what a visit was handed: the queued fd, else the node reopened
+    // one component at a time from the root with O_NOFOLLOW, so a directory
+    // swapped for a symlink since its parent was listed is not followed.
+    bool open(DirReader& reader, const Node* node, const int fd) const {
+        if (fd >= 0) return reader.adopt(fd);
+
+        std::vector<const Node*> chain;
+        for (; node->parent; node = node->parent) chain.push_back(node);
+
+        int dirFd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        for (auto it = chain.rbegin(); it != chain.rend() && dirFd >= 0; ++it) {
+            const int next = openat(dirFd, (*it)->name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            const int err = errno;
+            ::close(dirFd);
+            dirFd = next;
+            errno = err;
+        }
+        return reader.adopt(dirFd);
+    }
+
+    // A new child record of `parent`; fill it in, then queue() it.
+    Node& emplace(const size_t worker, Node* parent, const std::string_view name) {
+        Node& child = arenas[worker].emplace_back();
+        child.parent = parent;
+        child.name = name;
+        return child;
+    }
+
+    // Opens `child` relative to its parent's fd while the budget allows,
+    // counts it as pending on the parent and hands it to the pool.
+    void queue(const size_t worker, Node& child, const int parentFd) {
+        int childFd = -1;
+        if (queuedFds.fetch_add(1, std::memory_order_relaxed) < fdBudget) {
+            childFd = openat(parentFd, child.name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        if (childFd < 0) queuedFds.fetch_sub(1, std::memory_order_relaxed);
+
+        child.parent->pending.fetch_add(1, std::memory_order_relaxed);
+        pool.push(worker, Task{&child, childFd});
+    }
+
+    // Visits `node` once more, opening it by path; its pending count is the caller's.
+    void requeue(const size_t worker, Node* node) {
+        pool.push(worker, Task{node, -1});
+    }
+
+    [[nodiscard]] std::string pathOf(const Node* node) const {
+        std::vector<const Node*> chain;
+        for (; node->parent; node = node->parent) chain.push_back(node);
+
+        std::string path = root;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (path.empty() || path.back() != '/') path += '/';
+            path += (*it)->name;
+        }
+        return path;
+    }
+
+private:
+    std::string root;
+    WorkStealingPool<Task> pool;
+    std::vector<std::deque<Node>> arenas;
+    std::atomic<size_t> queuedFds{0};
+    size_t fdBudget = 0;
+};
@@ -0,0 +1,101 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Disk usage of a directory tree with one node per directory: files are
+// added to the directory they are in and never stored, so memory follows the
+// number of directories.
+//
+// Every directory is a task on a work-stealing pool. A task lists its
+// directory through the fd its parent opened for it, sums the files in
+// locals and stores them once. Each node counts the children it is still
+// waiting for; whoever finishes the last one adds the node's totals to its
+// parent with atomic adds and carries on upwards, so sizes accumulate
+// bottom-up (post-order) while the scan runs, without locks. Symlinks are
+// not followed.
+//
+// Sizes are kept twice: apparent (st_size) and allocated (st_blocks * 512),
+// which is what deleting gives back; sparse files and small files on large
+// blocks make the two differ. A file with several hard links is counted once,
+// in the first directory (in path order) that holds one of them.
+//
+// With an index file the scan is incremental. The index keeps, per
+// directory, its (dev, inode, mtime), the files directly inside it and its
+// subdirectories. A directory whose stamp still matches is not listed: its
+// own files and its subdirectory names come from the index, and only the
+// subdirectories are opened to check their own stamps. A deep change does
+// not touch the mtime of the directories above it, so every directory is
+// still visited, but an unchanged one costs an open and an fstat instead of
+// a listing plus a stat per file.
+//
+// A directory's mtime changes when entries are added, removed or renamed,
+// not when a file inside it is rewritten in place or gains a link elsewhere;
+// such changes show up only after a rescan without the index. Directories
+// with multi-link files are always listed, since their share of a link
+// depends on what else the scan visits.
+class DiskUsage {
+public:
+    static constexpr uint32_t kRoot = 0;
+
+    struct Node {
+        uint32_t parent;
+        uint32_t depth;
+        std::string name;
+        uint64_t bytes = 0;       // this directory and everything below it, apparent size
+        uint64_t allocated = 0;   // the same, in blocks actually allocated (st_blocks * 512)
+        uint64_t files = 0;
+    };
+
+    // Reuses what the index at `indexPath` still vouches for; empty for a full scan.
+    bool scan(const std::string& root, size_t threads, const std::string& indexPath = {});
+    // Writes the last scan as an index: mmap-able, temp file + rename().
+    bool saveIndex(const std::string& indexPath) const;
+    // Per-root file in the user cache directory, next to the line caches.
+    [[nodiscard]] static std::string defaultIndexPath(const std::string& root);
+
+    // Safe to read from another thread while scan() runs.
+    [[nodiscard]] uint64_t dirsScanned() const { return dirsDone.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t dirsReused() const { return dirsKept.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesScanned() const { return bytesDone.load(std::memory_order_relaxed); }
+
+    // Node ids are in no particular order, except that the root is 0.
+    [[nodiscard]] size_t size() const { return nodes.size(); }
+    [[nodiscard]] const Node& operator[](const uint32_t id) const { return nodes[id]; }
+    [[nodiscard]] std::string path(uint32_t id) const;
+    // Directories that could not be listed; their size is missing.
+    [[nodiscard]] size_t unreadable() const { return failures; }
+
+    // Bookkeeping after deleting below `id`, instead of a rescan: takes the
+    // amounts off `id` and every directory above it.
+    void discount(uint32_t id, uint64_t bytes, uint64_t allocated, uint64_t files);
+    // `id` and everything below it are gone.
+    void erase(uint32_t id);
+    // The same for several directories at once, in one pass over the nodes.
+    void erase(const std::vector<uint32_t>& ids);
+
+private:
+    // What the index needs beyond Node, by node id.
+    struct Stamp {
+        uint64_t dev = 0;
+        uint64_t ino = 0;
+        int64_t mtimeNs = 0;
+        uint64_t bytes = 0;   // files directly in the directory
+        uint64_t allocated = 0;
+        uint64_t files = 0;
+        bool valid = false;   // listed completely, safe to reuse next time
+    };
+
+    std::string rootPath;
+    std::vector<Node> nodes;
+    std::vector<Stamp> stamps;
+    size_t failures = 0;
+    std::atomic<uint64_t> dirsDone{0};
+    std::atomic<uint64_t> dirsKept{0};
+    std::atomic<uint64_t> bytesDone{0};
+};
@@ -0,0 +1,76 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Hash128 {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const Hash128&) const = default;
+    auto operator<=>(const Hash128&) const = default;
+};
+
+// MurmurHash3 x64_128, fed in pieces: every update() but the last must be a
+// multiple of 16 bytes long.
+class Murmur3 {
+public:
+    explicit Murmur3(uint64_t seed = 0) : h1(seed), h2(seed) {}
+
+    void update(const void* data, size_t size);
+    [[nodiscard]] Hash128 finish();
+
+private:
+    uint64_t h1;
+    uint64_t h2;
+    uint64_t length = 0;
+    unsigned char tail[16] = {};
+    size_t tailSize = 0;
+};
+
+// Files with the same content: one group per content, paths in byte order.
+// Hard links to one inode are a single entry, they take no extra space.
+struct DuplicateGroup {
+    uint64_t size = 0;
+    std::vector<std::string> paths;
+
+    [[nodiscard]] uint64_t wasted() const { return paths.size() > 1 ? size * (paths.size() - 1) : 0; }
+};
+
+// Three passes, each on far fewer files than the one before:
+//   1. walk the tree and group regular files by size; a unique size has no
+//      duplicate, whatever its content;
+//   2. hash the first and last 4 KB of every file left, which separates most
+//      same-size files (and settles files up to 8 KB outright);
+//   3. hash whole files that still collide, read in 1 MB chunks.
+// Passes 2 and 3 run on a work-stealing pool. Symlinks are not followed.
+class DuplicateFinder {
+public:
+    enum class Stage { Walking, Sampling, Hashing, Done };
+
+    bool find(const std::string& root, size_t threads, uint64_t minSize = 1);
+
+    // Largest waste first.
+    [[nodiscard]] const std::vector<DuplicateGroup>& groups() const { return found; }
+    // Files that could not be listed or read; they are left out.
+    [[nodiscard]] size_t unreadable() const { return failures; }
+
+    // Safe to read from another thread while find() runs.
+    [[nodiscard]] Stage stage() const { return current.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t filesSeen() const { return seen.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t hashed() const { return done.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t toHash() const { return total.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<DuplicateGroup> found;
+    size_t failures = 0;
+    std::atomic<Stage> current{Stage::Done};
+    std::atomic<uint64_t> seen{0};
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> total{0};
+};
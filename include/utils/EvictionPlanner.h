@@ -0,0 +1,63 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "CacheCatalog.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct EvictionCandidate {
+    std::string path;
+    uint64_t bytes = 0;         // allocated: what unlinking gives back
+    int64_t lastUsed = 0;       // newest of atime and mtime, seconds
+    uint32_t entry = 0;         // index into EvictionPlan::entries, its cache entry
+};
+
+struct EvictionPlan {
+    std::vector<EvictionCandidate> files;   // least recently used first
+    std::vector<std::string> entries;       // cache entries the files came from
+    std::vector<size_t> ruleOf;             // per entry, the rule that owns it
+    uint64_t target = 0;
+    uint64_t bytes = 0;                     // what deleting `files` frees
+    uint64_t available = 0;                 // every candidate together
+    uint64_t considered = 0;                // candidate files seen
+    size_t unreadable = 0;
+
+    [[nodiscard]] bool reachesTarget() const { return bytes >= target; }
+};
+
+// Picks the fewest least-recently-used files that free `target` bytes.
+//
+// Each file of the chosen targets is a candidate unless it is younger than
+// its rule's age= or has other hard links (unlinking it would free nothing).
+// Candidates stream through a max-heap keyed by last use: once the heap
+// holds `target` bytes without its newest file, that file is dropped. Memory
+// follows the size of the answer, not of the caches: whatever was dropped is
+// newer than everything kept, so it can never come back into the plan.
+//
+// Targets are walked on a work-stealing pool, one task per cache entry, each
+// worker with its own heap; the heaps are merged the same way at the end.
+class EvictionPlanner {
+public:
+    // `rules` are indices into catalog.rules(); empty means all of them.
+    EvictionPlan plan(const CacheCatalog& catalog, const std::vector<size_t>& rules, uint64_t target, size_t threads);
+
+    // Deletes the plan's files, oldest first, then every directory left empty
+    // below their cache entry (the entry itself stays). Returns bytes freed.
+    uint64_t execute(const EvictionPlan& plan);
+
+    // Safe to read from another thread while plan() or execute() runs.
+    [[nodiscard]] uint64_t filesSeen() const { return seen.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t filesRemoved() const { return removed.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesFreed() const { return freed.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t failures() const { return failed; }
+
+private:
+    std::atomic<uint64_t> seen{0};
+    std::atomic<uint64_t> removed{0};
+    std::atomic<uint64_t> freed{0};
+    size_t failed = 0;
+};
@@ -0,0 +1,14 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "Structs.h"
+#include <string_view>
+
+// Looks at the first 4 KB of `content` only: NUL bytes mean Binary, a
+// "generated by" / "DO NOT EDIT" / "@generated" style marker near the top
+// means Generated, and lines averaging hundreds of bytes mean Minified. Meant
+// to run on the buffer that is about to be counted, so it costs no extra I/O,
+// and for mmap'ed files it never touches the pages past the head.
+[[nodiscard]] FileKind sniffFile(std::string_view content);
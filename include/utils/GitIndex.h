@@ -0,0 +1,38 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Paths of the regular files tracked in a repository, read straight from
+// .git/index (versions 2, 3 and 4). Gitlinks, symlinks and the extra entries
+// of a merge conflict are left out. All paths share one string pool.
+class GitIndex {
+public:
+    // `root` must be the top of the work tree; .git may be a directory or a
+    // "gitdir: ..." file (worktrees, submodules).
+    bool load(const std::string& root);
+
+    // The git directory of the work tree at `root` (holds the index), empty
+    // when there is none.
+    static std::string indexPath(const std::string& root);
+    // Where config and info/ live: the main repository's git directory for a
+    // linked worktree (its "commondir" file), else `gitDir` itself.
+    static std::string commonDir(const std::string& gitDir);
+
+    [[nodiscard]] size_t size() const { return offsets.size() - 1; }
+    [[nodiscard]] std::string_view path(const size_t i) const {
+        return std::string_view(pool).substr(offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+private:
+    std::string pool;
+    std::vector<uint32_t> offsets{0};
+    size_t hashSize = 20;
+
+    bool parse(const unsigned char* data, size_t total);
+};
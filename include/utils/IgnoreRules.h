@@ -0,0 +1,55 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Patterns of one .gitignore-style file. Each line is compiled once into a
+// literal, a "*suffix" or a general glob (*, ?, [...], **), so matching a name
+// rarely needs the backtracking matcher.
+class IgnoreRules {
+public:
+    enum class Verdict { None, Ignore, Include };
+
+    void addLine(std::string_view line);
+    bool loadFile(const std::string& path);
+
+    [[nodiscard]] bool empty() const { return patterns.empty(); }
+    [[nodiscard]] bool needsPath() const { return anchored; }
+
+    // relPath is relative to the directory of the ignore file. Later patterns
+    // win, as in git; Include means a '!' pattern matched.
+    [[nodiscard]] Verdict match(std::string_view relPath, std::string_view name, bool isDir) const;
+
+    static bool globMatch(std::string_view pattern, std::string_view text);
+
+private:
+    enum class Kind { Literal, Suffix, Glob };
+
+    struct Pattern {
+        std::string glob;
+        Kind kind = Kind::Glob;
+        bool negate = false;
+        bool dirOnly = false;
+        bool anchored = false;
+    };
+
+    std::vector<Pattern> patterns;
+    bool anchored = false;
+};
+
+// Ignore files found while descending: each directory that has one links a
+// node to its parent's, so siblings share everything above them.
+struct IgnoreNode {
+    std::shared_ptr<const IgnoreNode> parent;
+    IgnoreRules rules;
+    std::string base;
+    bool needsPath = false;
+
+    // relPath is relative to the scanned root.
+    static bool isIgnored(const IgnoreNode* node, std::string_view relPath, std::string_view name, bool isDir);
+};
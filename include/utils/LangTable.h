@@ -0,0 +1,125 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "Structs.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using LangId = uint16_t;
+inline constexpr LangId kNoLang = 0xFFFF;
+
+struct BuiltinLang {
+    std::string_view key;
+    std::string_view name;
+    std::array<std::string_view, 6> extensions;
+    CommentSyntax syntax;
+};
+
+inline constexpr CommentSyntax kCStyle = {{"//"}, "/*", "*/", "\"'"};
+
+// Sorted by key: ids follow the order the reports have always been printed in.
+inline constexpr std::array<BuiltinLang, 13> kBuiltinLangs = {{
+    {"assembly", "Assembly",   {".asm"}, {{";", "#"}, "", "", "\"'"}},
+    {"cpp",      "C++",        {".h", ".hpp", ".tpp", ".cpp", ".cc", ".cxx"}, kCStyle},
+    {"cs",       "C#",         {".cs"}, kCStyle},
+    {"go",       "Go",         {".go"}, {{"//"}, "/*", "*/", "\"'`"}},
+    {"java",     "Java",       {".java"}, kCStyle},
+    {"js",       "JavaScript", {".js", ".jsx"}, {{"//"}, "/*", "*/", "\"'`"}},
+    {"kotlin",   "Kotlin",     {".kt", ".kts"}, kCStyle},
+    {"php",      "PHP",        {".php"}, {{"//", "#"}, "/*", "*/", "\"'"}},
+    {"python",   "Python",     {".py"}, {{"#"}, "", "", "\"'"}},
+    {"ruby",     "Ruby",       {".rb"}, {{"#"}, "=begin", "=end", "\"'"}},
+    {"rust",     "Rust",       {".rs"}, {{"//"}, "/*", "*/", "\""}},
+    {"swift",    "Swift",      {".swift"}, {{"//"}, "/*", "*/", "\""}},
+    {"ts",       "TypeScript", {".ts", ".tsx"}, {{"//"}, "/*", "*/", "\"'`"}}
+}};
+
+constexpr uint32_t extHash(const std::string_view s) {
+    uint32_t h = 2166136261u;
+    for (const char c : s) h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    return h;
+}
+
+struct ExtSlot {
+    std::string_view ext;
+    LangId id = kNoLang;
+};
+
+// Open-addressing table built at compile time; a lookup is one hash of the
+// extension bytes plus (almost always) a single compare.
+inline constexpr size_t kExtSlots = 64;
+
+consteval std::array<ExtSlot, kExtSlots> buildExtTable() {
+    std::array<ExtSlot, kExtSlots> table{};
+    for (size_t id = 0; id < kBuiltinLangs.size(); ++id) {
+        for (const auto& ext : kBuiltinLangs[id].extensions) {
+            if (ext.empty()) continue;
+            size_t slot = extHash(ext) % kExtSlots;
+            while (table[slot].id != kNoLang) slot = (slot + 1) % kExtSlots;
+            table[slot] = {ext, static_cast<LangId>(id)};
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<ExtSlot, kExtSlots> kExtTable = buildExtTable();
+
+constexpr LangId builtinLangOf(const std::string_view ext) {
+    for (size_t slot = extHash(ext) % kExtSlots; kExtTable[slot].id != kNoLang; slot = (slot + 1) % kExtSlots) {
+        if (kExtTable[slot].ext == ext) return kExtTable[slot].id;
+    }
+    return kNoLang;
+}
+
+static_assert(builtinLangOf(".cpp") == 1 && builtinLangOf(".tsx") == 12 && builtinLangOf(".c") == kNoLang);
+
+// Same rules as std::filesystem::path::extension(), without building a path.
+constexpr std::string_view extensionOf(const std::string_view path) {
+    const size_t slash = path.rfind('/');
+    const std::string_view name = slash == std::string_view::npos ? path : path.substr(slash + 1);
+    if (name == "." || name == "..") return {};
+
+    const size_t dot = name.rfind('.');
+    if (dot == std::string_view::npos || dot == 0) return {};
+    return name.substr(dot);
+}
+
+// Built-in languages followed by the ones the user declared at startup, both
+// addressed by a dense LangId so per-language totals can live in flat arrays.
+class LangTable {
+public:
+    LangTable();
+
+    [[nodiscard]] LangId find(std::string_view extension) const;
+    [[nodiscard]] LangId findKey(std::string_view key) const;
+    [[nodiscard]] size_t size() const { return languages.size(); }
+    [[nodiscard]] const LangConfig& operator[](const LangId id) const { return languages[id]; }
+    [[nodiscard]] const std::vector<LangConfig>& all() const { return languages; }
+    // User languages have no comment syntax: their lines are code or blank.
+    [[nodiscard]] CommentSyntax syntax(const LangId id) const {
+        return id < kBuiltinLangs.size() ? kBuiltinLangs[id].syntax : CommentSyntax{};
+    }
+    [[nodiscard]] uint32_t signature() const;
+
+    // "key=Name:.ext1,.ext2" - an existing key gets the extensions appended.
+    // Spaces around "=", ":" and "," are ignored.
+    bool addLanguage(const std::string& spec);
+    // One spec per line, '#' starts a comment. A missing file is not an error.
+    bool loadFile(const std::string& path);
+    static std::string defaultConfigPath();
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(const std::string_view s) const { return extHash(s); }
+    };
+
+    std::vector<LangConfig> languages;
+    std::unordered_map<std::string, LangId, StringHash, std::equal_to<>> userExtensions;
+};
@@ -0,0 +1,77 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "Structs.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+struct CacheRecord {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtimeNs;
+    uint64_t lines;
+    uint64_t code;
+    uint64_t comment;
+    uint64_t hash;      // contentHash() of the file, valid when `hashed`
+    uint32_t lang;
+    uint8_t kind;       // FileKind
+    uint8_t counted;    // lines/code/comment are valid (0 for skipped files)
+    uint8_t hashed;
+    uint8_t reserved;
+
+    [[nodiscard]] LineStats stats() const {
+        return {lines, code, comment, lines - code - comment};
+    }
+};
+static_assert(sizeof(CacheRecord) == 72);
+
+inline int64_t mtimeNs(const struct stat& st) {
+#if defined(__APPLE__)
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1'000'000'000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+// $XDG_CACHE_HOME/cliutils (or ~/.cache/cliutils)/<hash of the absolute root>
+// followed by `extension`, one file per tool and root.
+[[nodiscard]] std::string cacheFilePath(const std::string& root, const std::string& extension);
+
+// On-disk line statistics keyed by (dev, inode, size, mtime) so unchanged
+// files are answered from a stat alone. The file is a header followed by
+// records sorted by (dev, ino); it is mmap'ed read-only, so lookups are safe
+// from any thread, and rewritten through a temporary file + rename().
+class LineCache {
+public:
+    LineCache(const std::string& root, uint32_t tableSignature);
+    ~LineCache();
+    LineCache(const LineCache&) = delete;
+    LineCache& operator=(const LineCache&) = delete;
+
+    [[nodiscard]] const CacheRecord* find(const struct stat& st, uint32_t lang) const;
+    [[nodiscard]] size_t size() const { return count; }
+
+    // Replaces the cache with `records`. With keepUnseen the old records whose
+    // file was not part of this scan survive (partial scans must not evict them).
+    bool save(std::vector<CacheRecord> records, bool keepUnseen) const;
+
+    static CacheRecord makeRecord(const struct stat& st, const LineStats& stats, uint32_t lang,
+                                  FileKind kind = FileKind::Source, bool counted = true,
+                                  std::optional<uint64_t> hash = std::nullopt);
+
+private:
+    std::string path;
+    uint32_t signature;
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+    const CacheRecord* records = nullptr;
+    size_t count = 0;
+
+    void load();
+};
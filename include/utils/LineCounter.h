@@ -0,0 +1,20 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Number of '\n' bytes in [data, data + size). Uses AVX2/SSE2 (x86-64) or NEON
+// (arm64), picked once at runtime from the CPU features.
+[[nodiscard]] size_t countNewlines(const char* data, size_t size);
+
+// Line count with std::getline semantics: a trailing line without '\n' counts.
+[[nodiscard]] size_t countLines(std::string_view content);
+
+// Hands the whole file to `consume` without copying it into std::string:
+// large files are mmap'ed, small ones are pread into a per-thread buffer that
+// is reused between calls. Returns false if the file cannot be opened or read.
+bool readFile(const std::string& path, const std::function<void(std::string_view)>& consume);
@@ -0,0 +1,44 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "Structs.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Splits a file into code / comment / blank lines in one pass without
+// allocating. The input can arrive in any number of chunks; a comment marker or
+// escape cut by a chunk boundary is carried over to the next feed().
+// A line with any code counts as code, otherwise as comment if it has comment
+// text, otherwise as blank. lines == code + comment + blank, and matches
+// countLines() for the same bytes.
+class LineLexer {
+public:
+    explicit LineLexer(const CommentSyntax& syntax);
+
+    void feed(std::string_view chunk);
+    LineStats finish();
+
+    static LineStats classify(const CommentSyntax& syntax, std::string_view content);
+
+private:
+    enum class State : uint8_t { Code, LineComment, BlockComment, String };
+    static constexpr size_t kMaxCarry = 8;
+
+    CommentSyntax syntax;
+    std::array<uint8_t, 256> classes{};
+    State state = State::Code;
+    char quote = 0;
+    bool lineOpen = false;
+    bool hasCode = false;
+    bool hasComment = false;
+    LineStats stats;
+
+    std::array<char, kMaxCarry> carry{};
+    size_t carrySize = 0;
+
+    size_t scan(const char* data, size_t size, bool final);
+    void endLine();
+};
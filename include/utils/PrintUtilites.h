@@ -330,15 +330,15 @@ inline void printTable(const std::vector<FileStats>& headers,
               << colorText(BWhite, "┘\n");
 }
 
-inline void printByLanguage(const std::map<std::string, std::vector<FileStats>>& filesByLang,
-                            const std::map<std::string, size_t>& totalsByLang,
-                            const std::map<std::string, LangConfig>& languageMap) {
+inline void printByLanguage(const std::vector<std::vector<FileStats>>& filesByLang,
+                            const std::vector<LineStats>& totalsByLang,
+                            const std::vector<LangConfig>& languages) {
 
-    for (const auto& [langKey, files] : filesByLang) {
+    for (size_t lang = 0; lang < filesByLang.size(); ++lang) {
+        const auto& files = filesByLang[lang];
+        if (files.empty()) continue;
 
-        std::string langName = langKey;
-        auto itMap = languageMap.find(langKey);
-        if (itMap != languageMap.end()) langName = itMap->second.name;
+        const std::string& langName = languages[lang].name;
 
         std::vector<std::string> lines;
         lines.push_back("Language: " + langName);
@@ -357,10 +357,43 @@ inline void printByLanguage(const std::map<std::string, std::vector<FileStats>>&
             }
         }
 
-        size_t langTotal = 0;
-        auto it = totalsByLang.find(langKey);
-        if (it != totalsByLang.end()) langTotal = it->second;
-        lines.push_back(" └ Overall lines: " + std::to_string(langTotal));
+        const LineStats& langTotal = totalsByLang[lang];
+        lines.push_back(" ├ Code: " + std::to_string(langTotal.code)
+                        + ", Comments: " + std::to_string(langTotal.comment)
+                        + ", Blank: " + std::to_string(langTotal.blank));
+        lines.push_back(" └ Overall lines: " + std::to_string(langTotal.lines));
+
+        int maxWidth = 0;
+        for (const auto& l : lines) maxWidth = std::max(maxWidth, static_cast<int>(l.size()));
+        const int leftPadding = std::max(0, (termWidth() - maxWidth) / 2);
+
+        for (const auto& l : lines) {
+            std::cout << std::string(leftPadding, ' ') << colorText(BWhite, l) << "\n";
+        }
+        std::cout << "\n";
+    }
+}
+
+inline void printTopByLanguage(const std::vector<std::vector<FileStats>>& topByLang,
+                               const std::vector<size_t>& filesByLang,
+                               const std::vector<LineStats>& totalsByLang,
+                               const std::vector<LangConfig>& languages) {
+
+    for (size_t lang = 0; lang < topByLang.size(); ++lang) {
+        if (filesByLang[lang] == 0) continue;
+
+        std::vector<std::string> lines;
+        lines.push_back("Language: " + languages[lang].name + " (" + std::to_string(filesByLang[lang]) + " files)");
+        lines.push_back(" ├ Largest " + std::to_string(topByLang[lang].size()));
+        for (const auto& f : topByLang[lang]) {
+            lines.push_back(" │   " + f.name + " - " + std::to_string(f.lines));
+        }
+
+        const LineStats& langTotal = totalsByLang[lang];
+        lines.push_back(" ├ Code: " + std::to_string(langTotal.code)
+                        + ", Comments: " + std::to_string(langTotal.comment)
+                        + ", Blank: " + std::to_string(langTotal.blank));
+        lines.push_back(" └ Overall lines: " + std::to_string(langTotal.lines));
 
         int maxWidth = 0;
         for (const auto& l : lines) maxWidth = std::max(maxWidth, static_cast<int>(l.size()));
@@ -0,0 +1,120 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "Structs.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One counted file. Paths are relative to the scanned root, so snapshots of
+// two checkouts in different places can be compared.
+struct SnapshotEntry {
+    std::string path;
+    uint32_t lang = 0;      // index into the snapshot's language names
+    LineStats stats;
+    uint64_t hash = 0;      // content hash, 0 when unknown (unreadable, or an archive member)
+};
+
+[[nodiscard]] uint64_t contentHash(std::string_view data);
+
+// Entries are stored sorted by path (byte order), each path as the length it
+// shares with the previous one plus the rest, and the numbers as varints, so
+// a 1M-file tree fits in a few tens of MB. Languages are stored by name: the
+// ids of two runs with different --lang settings need not agree.
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool open(const std::string& path, const std::vector<std::string>& languages);
+    // Paths must arrive strictly increasing.
+    bool add(const SnapshotEntry& entry);
+    // Writes the entry count and moves the file into place.
+    bool finish();
+
+    [[nodiscard]] const std::string& error() const { return failure; }
+
+private:
+    std::string target;
+    std::string temp;
+    int fd = -1;
+    std::string buffer;
+    std::string previous;
+    uint64_t count = 0;
+    std::string failure;
+
+    bool flush();
+    bool fail(const std::string& message);
+};
+
+// Streams a snapshot back one entry at a time; memory does not grow with it.
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    [[nodiscard]] static bool isSnapshot(const std::string& path);
+
+    bool open(const std::string& path);
+    bool next(SnapshotEntry& entry);
+
+    [[nodiscard]] const std::vector<std::string>& languages() const { return names; }
+    [[nodiscard]] uint64_t size() const { return count; }
+    [[nodiscard]] const std::string& error() const { return failure; }
+
+private:
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    std::vector<std::string> names;
+    uint64_t count = 0;
+    uint64_t consumed = 0;
+    std::string previous;
+    std::string failure;
+
+    bool fill();
+    bool readBytes(char* out, size_t size);
+    bool readVarint(uint64_t& value);
+    bool fail(const std::string& message);
+};
+
+struct LineDelta {
+    size_t filesAdded = 0;
+    size_t filesRemoved = 0;
+    size_t filesChanged = 0;
+    size_t linesAdded = 0;
+    size_t linesRemoved = 0;
+
+    [[nodiscard]] bool empty() const { return filesAdded + filesRemoved + filesChanged == 0; }
+    [[nodiscard]] size_t churn() const { return linesAdded + linesRemoved; }
+};
+
+struct SnapshotDiff {
+    std::map<std::string, LineDelta> byLang;
+    std::unordered_map<std::string, LineDelta> byDir;   // directory cut to `depth` levels, "." for the root
+    LineDelta total;
+    size_t unchanged = 0;
+};
+
+// Yields entries in path order; returns false when exhausted.
+using EntrySource = std::function<bool(SnapshotEntry& entry)>;
+
+// One merge pass over two sorted streams: linear time, and memory bounded by
+// the number of languages and directories, never by the number of files.
+// A file whose hash or line count differs is "changed"; its lines count as
+// added or removed by the difference of the two line counts. When either
+// side has no hash, the line counts alone decide.
+[[nodiscard]] SnapshotDiff diffSnapshots(const EntrySource& before, const std::vector<std::string>& beforeLangs,
+                                         const EntrySource& after, const std::vector<std::string>& afterLangs,
+                                         size_t depth);
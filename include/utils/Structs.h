@@ -3,8 +3,10 @@
 //
 
 #pragma once
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct FileStats {
@@ -12,14 +14,74 @@ struct FileStats {
     size_t lines;
 };
 
+struct LineStats {
+    size_t lines = 0;
+    size_t code = 0;
+    size_t comment = 0;
+    size_t blank = 0;
+
+    LineStats& operator+=(const LineStats& other) {
+        lines += other.lines;
+        code += other.code;
+        comment += other.comment;
+        blank += other.blank;
+        return *this;
+    }
+
+    LineStats& operator-=(const LineStats& other) {
+        lines -= other.lines;
+        code -= other.code;
+        comment -= other.comment;
+        blank -= other.blank;
+        return *this;
+    }
+};
+
+// What the first few KB of a file look like. Anything but Source is left out
+// of the totals unless CodeCounter is run with --all-files.
+enum class FileKind : uint8_t { Source, Generated, Minified, Binary };
+
+struct SkippedFiles {
+    size_t generated = 0;
+    size_t minified = 0;
+    size_t binary = 0;
+
+    void add(const FileKind kind) {
+        switch (kind) {
+            case FileKind::Generated: ++generated; break;
+            case FileKind::Minified:  ++minified; break;
+            case FileKind::Binary:    ++binary; break;
+            case FileKind::Source:    break;
+        }
+    }
+
+    [[nodiscard]] size_t total() const { return generated + minified + binary; }
+
+    SkippedFiles& operator+=(const SkippedFiles& other) {
+        generated += other.generated;
+        minified += other.minified;
+        binary += other.binary;
+        return *this;
+    }
+};
+
+struct CommentSyntax {
+    std::string_view line[2];
+    std::string_view blockOpen;
+    std::string_view blockClose;
+    std::string_view quotes;
+};
+
 struct LangConfig {
     std::vector<std::string> extension;
     std::string name;
+    std::string key;
 };
 
 struct Row {
     std::string index;
     std::string shortPath;
     std::string sizeDir;
+    std::string apparentDir;
     std::filesystem::path fullPath;
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+typedef struct z_stream_s z_stream;
+
+// Walks the regular files of a .tar / .tar.gz / .tgz archive in one forward
+// pass, without writing anything to disk. Member content is handed out as
+// views into the (decompression) buffer, so memory stays at one buffer and
+// the current member's name whatever the archive size. Understands ustar,
+// GNU long names ('L') and pax path/size records.
+class TarReader {
+public:
+    struct Member {
+        std::string path;
+        uint64_t size = 0;
+    };
+
+    TarReader();
+    ~TarReader();
+    TarReader(const TarReader&) = delete;
+    TarReader& operator=(const TarReader&) = delete;
+
+    static bool isArchive(std::string_view path);
+
+    // gzip is detected from the magic bytes, not the extension.
+    bool open(const std::string& path);
+
+    // Moves to the next regular file, skipping whatever is left of the current
+    // one. Returns false at the end of the archive or on a damaged one.
+    bool next(Member& member);
+
+    // The next piece of the current member's content; empty once it is done.
+    std::string_view read();
+
+    [[nodiscard]] const std::string& error() const { return failure; }
+
+private:
+    int fd = -1;
+    z_stream* zs = nullptr;
+    std::vector<char> input;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+
+    uint64_t remaining = 0;
+    uint64_t padding = 0;
+    std::string failure;
+
+    bool fill();
+    bool readExact(char* out, size_t size);
+    bool skip(uint64_t size);
+    bool readText(uint64_t size, std::string& out);
+    bool fail(const std::string& message);
+    void close();
+};
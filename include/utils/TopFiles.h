@@ -0,0 +1,63 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include "Structs.h"
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+// The `limit` largest files offered so far, kept as a min-heap: a file that
+// does not beat the smallest one kept costs a single comparison and no copy
+// of its name, so memory stays at `limit` entries for any number of files.
+class TopFiles {
+public:
+    explicit TopFiles(const size_t limit = 0) : limit(limit) {
+        heap.reserve(limit);
+    }
+
+    void offer(const std::string_view name, const size_t lines) {
+        ++offered;
+        if (limit == 0) return;
+        if (heap.size() == limit) {
+            if (!better(lines, name, heap.front())) return;
+            std::ranges::pop_heap(heap, worse);
+            heap.back().name.assign(name);
+            heap.back().lines = lines;
+        } else {
+            heap.push_back({std::string(name), lines});
+        }
+        std::ranges::push_heap(heap, worse);
+    }
+
+    void merge(TopFiles&& other) {
+        offered += other.offered - other.heap.size();
+        for (auto& file : other.heap) offer(file.name, file.lines);
+        other.heap.clear();
+        other.offered = 0;
+    }
+
+    // How many files were offered, kept or not.
+    [[nodiscard]] size_t count() const { return offered; }
+
+    // Largest first; equal sizes by name so the report does not depend on
+    // which thread saw which file.
+    [[nodiscard]] std::vector<FileStats> take() {
+        std::ranges::sort_heap(heap, worse);
+        return std::move(heap);
+    }
+
+private:
+    size_t limit;
+    size_t offered = 0;
+    std::vector<FileStats> heap;
+
+    static bool better(const size_t lines, const std::string_view name, const FileStats& than) {
+        return lines != than.lines ? lines > than.lines : name < than.name;
+    }
+
+    static bool worse(const FileStats& a, const FileStats& b) {
+        return better(a.lines, a.name, b);
+    }
+};
@@ -0,0 +1,73 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Deletes a directory tree in the background so the caller can keep drawing
+// and take a cancel key. Every directory is a task on a work-stealing pool:
+// its files are unlinked with unlinkat() relative to the directory's own fd,
+// subdirectories become tasks of their own, and the last task to finish
+// under a directory removes it. Symlinks are removed, never followed.
+//
+// Cancelling stops listing and queueing at once; what was deleted stays
+// deleted and the rest of the tree is left in place.
+class TreeRemover {
+public:
+    // What went from one directory itself, its subdirectories not included.
+    struct RemovedDir {
+        std::string path;
+        uint64_t files = 0;     // regular files
+        uint64_t bytes = 0;     // their st_size
+        uint64_t freed = 0;     // their blocks, for files whose last link went
+        bool gone = false;      // the directory itself was removed
+    };
+
+    TreeRemover() = default;
+    ~TreeRemover();
+    TreeRemover(const TreeRemover&) = delete;
+    TreeRemover& operator=(const TreeRemover&) = delete;
+
+    // Returns at once; `path` may also be a single file or symlink.
+    void start(const std::string& path, size_t threads);
+    void cancel() { stop.store(true, std::memory_order_relaxed); }
+    void wait();
+
+    [[nodiscard]] bool finished() const { return done.load(std::memory_order_acquire); }
+    [[nodiscard]] bool cancelled() const { return stop.load(std::memory_order_relaxed); }
+    // `path` no longer exists. Valid once finished.
+    [[nodiscard]] bool removed() const { return gone; }
+
+    // Safe to read while the removal runs.
+    [[nodiscard]] uint64_t filesRemoved() const { return files.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t dirsRemoved() const { return dirs.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesRemoved() const { return bytes.load(std::memory_order_relaxed); }
+    // Blocks given back: files whose last link went (st_blocks * 512).
+    [[nodiscard]] uint64_t bytesFreed() const { return freed.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t failures() const { return failed.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::string firstError() const;
+    // Every directory that lost files or was removed. Valid once finished.
+    [[nodiscard]] const std::vector<RemovedDir>& removedDirs() const { return touched; }
+
+private:
+    std::thread runner;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> done{false};
+    bool gone = false;
+    std::atomic<uint64_t> files{0};
+    std::atomic<uint64_t> dirs{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> freed{0};
+    std::atomic<uint64_t> failed{0};
+    mutable std::mutex errorMutex;
+    std::string error;
+    std::vector<RemovedDir> touched;
+
+    void run(const std::string& path, size_t threads);
+};
@@ -0,0 +1,53 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Change feed for a whole directory tree, built on inotify (Linux only; on
+// other systems start() fails). Every directory gets its own watch, and new
+// directories are picked up as they appear. All paths are relative to the root.
+class TreeWatcher {
+public:
+    // Returns true for directories that must not be watched (build trees,
+    // ignored folders); relPath is relative to the root.
+    using DirFilter = std::function<bool(std::string_view relPath)>;
+
+    struct Changes {
+        std::vector<std::string> files;   // created, written, moved or deleted
+        std::vector<std::string> dirs;    // subtrees that appeared or disappeared
+        bool overflow = false;            // the kernel dropped events, rescan
+
+        [[nodiscard]] bool empty() const { return files.empty() && dirs.empty() && !overflow; }
+    };
+
+    TreeWatcher() = default;
+    ~TreeWatcher();
+    TreeWatcher(const TreeWatcher&) = delete;
+    TreeWatcher& operator=(const TreeWatcher&) = delete;
+
+    bool start(const std::string& rootPath, DirFilter filter);
+
+    // Waits up to timeoutMs for the first event, then keeps reading until the
+    // tree has been quiet for settleMs, so an editor's save storm (temp file,
+    // rename, chmod, ...) arrives as one batch with every path listed once.
+    Changes poll(int timeoutMs, int settleMs);
+
+    [[nodiscard]] size_t watched() const { return dirs.size(); }
+    [[nodiscard]] size_t failed() const { return failures; }
+
+private:
+    std::string root;
+    DirFilter skip;
+    int fd = -1;
+    size_t failures = 0;
+    std::unordered_map<int, std::string> dirs;
+
+    void addTree(const std::string& relDir);
+    void dropTree(const std::string& relDir);
+};
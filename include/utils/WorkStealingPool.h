@@ -0,0 +1,116 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+inline size_t defaultThreadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Every worker owns a deque: it pushes and pops work at the back (LIFO, keeps
+// the walk depth-first and cache friendly) while idle workers steal from the
+// front of somebody else's deque. Tasks may push more tasks; run() returns once
+// no task is queued or executing.
+template <typename Task>
+class WorkStealingPool {
+public:
+    using Handler = std::function<void(size_t worker, Task& task)>;
+
+    explicit WorkStealingPool(const size_t threads)
+        : queues(std::max<size_t>(1, threads)) {
+        for (auto& q : queues) q = std::make_unique<Queue>();
+    }
+
+    [[nodiscard]] size_t size() const { return queues.size(); }
+
+    void push(const size_t worker, Task task) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(queues[worker % queues.size()]->m);
+            queues[worker % queues.size()]->tasks.push_back(std::move(task));
+        }
+        idle.notify_one();
+    }
+
+    void run(std::vector<Task> seeds, const Handler& handler) {
+        for (size_t i = 0; i < seeds.size(); ++i) push(i, std::move(seeds[i]));
+
+        std::vector<std::thread> threads;
+        threads.reserve(queues.size() - 1);
+        for (size_t w = 1; w < queues.size(); ++w) {
+            threads.emplace_back([this, w, &handler] { workerLoop(w, handler); });
+        }
+        workerLoop(0, handler);
+        for (auto& t : threads) t.join();
+
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<size_t> pending{0};
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    bool take(const size_t worker, Task& out) {
+        {
+            Queue& own = *queues[worker];
+            std::lock_guard lock(own.m);
+            if (!own.tasks.empty()) {
+                out = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue& victim = *queues[(worker + i) % queues.size()];
+            std::lock_guard lock(victim.m);
+            if (!victim.tasks.empty()) {
+                out = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(const size_t worker, const Handler& handler) {
+        Task task;
+        while (true) {
+            if (take(worker, task)) {
+                try {
+                    handler(worker, task);
+                } catch (...) {
+                    std::lock_guard lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) idle.notify_all();
+                continue;
+            }
+
+            if (pending.load(std::memory_order_acquire) == 0) return;
+
+            std::unique_lock lock(idleMutex);
+            idle.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+};
@@ -12,4 +12,6 @@ class Command {
 public:
     virtual ~Command() = default;
     virtual void execute(const std::vector<std::string>& args) = 0;
+    // Process exit status after a non-interactive execute().
+    [[nodiscard]] virtual int exitCode() const { return 0; }
 };
\ No newline at end of file
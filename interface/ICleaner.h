@@ -11,4 +11,7 @@ public:
     virtual std::string getStats(const std::string& path) const = 0;
     virtual void removeFile() = 0;
     virtual void largeDirectory() = 0;
+    virtual void duplicateFiles() = 0;
+    virtual void cacheReport() = 0;
+    virtual void freeSpace() = 0;
 };
@@ -0,0 +1,278 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "BatchReader.h"
+#include "LineCounter.h"
+#include <algorithm>
+#include <cerrno>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_FILE_INDEX_ALLOC)
+#define CLIUTILS_URING 1
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+#if defined(CLIUTILS_URING)
+
+namespace {
+
+// Each slot is one file in flight: a direct descriptor in the registered file
+// table and a window of the registered buffer. Smaller files dominate source
+// trees, anything that fills its window is re-read with readFile().
+constexpr unsigned kSlots = 64;
+constexpr size_t kSlotSize = 32 * 1024;
+constexpr unsigned kOpsPerFile = 3;
+
+enum Op : uint64_t { OpOpen = 0, OpRead = 1, OpClose = 2 };
+
+int uringSetup(const unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(const int fd, const unsigned submit, const unsigned wait) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, IORING_ENTER_GETEVENTS, nullptr, 0));
+}
+
+int uringRegister(const int fd, const unsigned opcode, const void* arg, const unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+}
+
+struct BatchReader::Ring {
+    int fd = -1;
+    void* sqMap = MAP_FAILED;
+    void* cqMap = MAP_FAILED;
+    size_t sqMapSize = 0;
+    size_t cqMapSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned cqMask = 0;
+
+    std::unique_ptr<char[]> buffers;
+    bool fixedBuffers = false;
+    bool broken = false;
+
+    struct Slot {
+        size_t index = 0;
+        unsigned pending = 0;
+        bool handled = false;
+    };
+    Slot slots[kSlots];
+    std::vector<unsigned> freeSlots;
+
+    bool setup();
+    ~Ring();
+
+    void queue(unsigned slot, const std::string& path);
+    size_t read(const std::vector<std::string>& paths, const Consumer& consume);
+};
+
+bool BatchReader::Ring::setup() {
+    io_uring_params params{};
+    fd = uringSetup(kSlots * kOpsPerFile, &params);
+    if (fd < 0) return false;
+
+    // Direct descriptors for openat/close need 5.15; the probe catches kernels
+    // that lack the opcodes, a failing openat catches the rest at run time.
+    alignas(io_uring_probe) unsigned char probeData[sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)]{};
+    auto* probe = reinterpret_cast<io_uring_probe*>(probeData);
+    if (uringRegister(fd, IORING_REGISTER_PROBE, probe, 256) < 0) return false;
+    for (const unsigned op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+    }
+
+    sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+
+    sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqMap == MAP_FAILED) return false;
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        cqMap = sqMap;
+    } else {
+        cqMap = mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqMap == MAP_FAILED) return false;
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqeMap == MAP_FAILED) return false;
+    sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+    auto* sq = static_cast<char*>(sqMap);
+    auto* cq = static_cast<char*>(cqMap);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+
+    int files[kSlots];
+    std::fill(std::begin(files), std::end(files), -1);
+    if (uringRegister(fd, IORING_REGISTER_FILES, files, kSlots) < 0) return false;
+
+    // Registering the buffer pins it once instead of on every read; a low
+    // RLIMIT_MEMLOCK on older kernels just means plain reads.
+    buffers = std::make_unique<char[]>(kSlots * kSlotSize);
+    const iovec iov{buffers.get(), kSlots * kSlotSize};
+    fixedBuffers = uringRegister(fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+
+    freeSlots.reserve(kSlots);
+    for (unsigned slot = kSlots; slot-- > 0;) freeSlots.push_back(slot);
+    return true;
+}
+
+BatchReader::Ring::~Ring() {
+    if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+    if (cqMap != MAP_FAILED && cqMap != sqMap) munmap(cqMap, cqMapSize);
+    if (sqMap != MAP_FAILED) munmap(sqMap, sqMapSize);
+    if (fd >= 0) close(fd);
+}
+
+// open -> read -> close as one chain. The read is hard-linked so that the
+// close still runs after the short read every small file ends with.
+void BatchReader::Ring::queue(const unsigned slot, const std::string& path) {
+    unsigned tail = *sqTail;
+    auto next = [&](const Op op) {
+        const unsigned at = tail & sqMask;
+        io_uring_sqe* sqe = &sqes[at];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = static_cast<uint64_t>(slot) << 2 | op;
+        sqArray[at] = at;
+        ++tail;
+        return sqe;
+    };
+
+    io_uring_sqe* open = next(OpOpen);
+    open->opcode = IORING_OP_OPENAT;
+    open->fd = AT_FDCWD;
+    open->addr = reinterpret_cast<uint64_t>(path.c_str());
+    open->open_flags = O_RDONLY; // direct descriptors reject O_CLOEXEC
+    open->file_index = slot + 1;
+    open->flags = IOSQE_IO_LINK;
+
+    io_uring_sqe* read = next(OpRead);
+    read->opcode = fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    read->fd = static_cast<int>(slot);
+    read->addr = reinterpret_cast<uint64_t>(buffers.get() + slot * kSlotSize);
+    read->len = kSlotSize;
+    read->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+
+    io_uring_sqe* closing = next(OpClose);
+    closing->opcode = IORING_OP_CLOSE;
+    closing->file_index = slot + 1;
+
+    __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+    slots[slot] = Slot{0, kOpsPerFile, false};
+}
+
+// Returns how many leading paths were taken on; the caller reads the rest.
+size_t BatchReader::Ring::read(const std::vector<std::string>& paths, const Consumer& consume) {
+    auto fallback = [&](const size_t index) {
+        readFile(paths[index], [&](const std::string_view content) { consume(index, content); });
+    };
+
+    size_t next = 0;
+    size_t active = 0;
+
+    while (next < paths.size() || active > 0) {
+        while (!broken && next < paths.size() && !freeSlots.empty()) {
+            const unsigned slot = freeSlots.back();
+            freeSlots.pop_back();
+            queue(slot, paths[next]);
+            slots[slot].index = next++;
+            ++active;
+        }
+        if (active == 0) break;
+
+        const unsigned unsubmitted = *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (uringEnter(fd, unsubmitted, 1) < 0 && errno != EINTR) {
+            // The ring is unusable; whatever it still holds is read again and
+            // the table is dropped with it.
+            broken = true;
+            for (const Slot& slot : slots) {
+                if (slot.pending > 0 && !slot.handled) fallback(slot.index);
+            }
+            return next;
+        }
+
+        unsigned head = *cqHead;
+        const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            const auto slotId = static_cast<unsigned>(cqe.user_data >> 2);
+            const auto op = static_cast<Op>(cqe.user_data & 3);
+            Slot& slot = slots[slotId];
+
+            if (op == OpOpen && cqe.res == -EINVAL) broken = true;
+            if (op == OpRead) {
+                slot.handled = true;
+                if (cqe.res >= 0 && static_cast<size_t>(cqe.res) < kSlotSize) {
+                    consume(slot.index, std::string_view(buffers.get() + slotId * kSlotSize,
+                                                         static_cast<size_t>(cqe.res)));
+                } else {
+                    fallback(slot.index);
+                }
+            }
+            if (--slot.pending == 0) {
+                freeSlots.push_back(slotId);
+                --active;
+            }
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+    return next;
+}
+
+#else
+
+struct BatchReader::Ring {
+    bool broken = true;
+    static bool setup() { return false; }
+    static size_t read(const std::vector<std::string>&, const Consumer&) { return 0; }
+};
+
+#endif
+
+BatchReader::BatchReader(const bool useUring) {
+    if (!useUring) return;
+    ring = std::make_unique<Ring>();
+    if (!ring->setup()) ring.reset();
+}
+
+BatchReader::~BatchReader() = default;
+BatchReader::BatchReader(BatchReader&&) noexcept = default;
+BatchReader& BatchReader::operator=(BatchReader&&) noexcept = default;
+
+bool BatchReader::usesUring() const {
+    return ring && !ring->broken;
+}
+
+void BatchReader::read(const std::vector<std::string>& paths, const Consumer& consume) {
+    size_t next = 0;
+    if (usesUring()) next = ring->read(paths, consume);
+
+    for (; next < paths.size(); ++next) {
+        readFile(paths[next], [&](const std::string_view content) { consume(next, content); });
+    }
+}
@@ -0,0 +1,378 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "CacheCatalog.h"
+#include "DirReader.h"
+#include "IgnoreRules.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
+namespace {
+
+// Specific targets come before the folders that contain them, so a path
+// both match is reported under its own name.
+#if defined(__APPLE__)
+constexpr std::string_view kDefaultRules = R"(
+pip      ~/Library/Caches/pip
+ccache   ~/Library/Caches/ccache ~/.ccache
+bazel    ~/Library/Caches/bazel /private/var/tmp/_bazel_*
+cache    ~/Library/Caches/*
+xcode    ~/Library/Developer/Xcode/DerivedData/*
+safari   ~/Library/Safari/LocalStorage/*
+npm      ~/.npm/_cacache
+cargo    ~/.cargo/registry/cache/* ~/.cargo/registry/src/* ~/.cargo/git/checkouts/*
+gradle   ~/.gradle/caches/*
+)";
+#else
+constexpr std::string_view kDefaultRules = R"(
+pip      ~/.cache/pip
+ccache   ~/.cache/ccache ~/.ccache
+bazel    ~/.cache/bazel
+npm      ~/.npm/_cacache
+cargo    ~/.cargo/registry/cache/* ~/.cargo/registry/src/* ~/.cargo/git/checkouts/*
+gradle   ~/.gradle/caches/*
+cache    ~/.cache/*                                     age=7d
+)";
+#endif
+
+// Whitespace splits, "\ " does not; escapes are kept for the glob matcher.
+std::vector<std::string> tokens(const std::string_view line) {
+    std::vector<std::string> out;
+    std::string current;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (c == '\\' && i + 1 < line.size()) {
+            current += c;
+            current += line[++i];
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!current.empty()) out.push_back(std::move(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) out.push_back(std::move(current));
+    return out;
+}
+
+bool hasWildcard(const std::string_view segment) {
+    for (size_t i = 0; i < segment.size(); ++i) {
+        if (segment[i] == '\\') ++i;
+        else if (segment[i] == '*' || segment[i] == '?' || segment[i] == '[') return true;
+    }
+    return false;
+}
+
+std::string unescape(const std::string_view segment) {
+    std::string out;
+    for (size_t i = 0; i < segment.size(); ++i) {
+        if (segment[i] == '\\' && i + 1 < segment.size()) ++i;
+        out += segment[i];
+    }
+    return out;
+}
+
+std::string expandHome(const std::string& glob) {
+    if (glob == "~" || glob.starts_with("~/")) {
+        const char* home = getenv("HOME");
+        return home ? std::string(home) + glob.substr(1) : std::string{};
+    }
+    return glob;
+}
+
+// Sizes and the last use of everything under `path`, symlinks not followed.
+// Directories give only their mtime: listing them moves their atime.
+void measure(CacheEntry& entry, size_t& unreadable, std::atomic<uint64_t>& seen) {
+    struct stat st{};
+    if (lstat(entry.path.c_str(), &st) != 0) {
+        ++unreadable;
+        return;
+    }
+    entry.allocated = static_cast<uint64_t>(st.st_blocks) * 512;
+    seen.fetch_add(entry.allocated, std::memory_order_relaxed);
+    if (!S_ISDIR(st.st_mode)) {
+        entry.bytes = static_cast<uint64_t>(st.st_size);
+        entry.files = 1;
+        entry.lastUsed = lastUse(st);
+        return;
+    }
+    entry.lastUsed = static_cast<int64_t>(st.st_mtime);
+
+    unreadable += walkTree(entry.path, [&](const std::string&, std::string_view, const struct stat& child) {
+        const auto allocated = static_cast<uint64_t>(child.st_blocks) * 512;
+        entry.allocated += allocated;
+        seen.fetch_add(allocated, std::memory_order_relaxed);
+        if (S_ISDIR(child.st_mode)) {
+            entry.lastUsed = std::max(entry.lastUsed, static_cast<int64_t>(child.st_mtime));
+            return;
+        }
+        entry.bytes += static_cast<uint64_t>(child.st_size);
+        ++entry.files;
+        entry.lastUsed = std::max(entry.lastUsed, lastUse(child));
+    });
+}
+
+}
+
+int64_t lastUse(const struct stat& st) {
+    return std::max(static_cast<int64_t>(st.st_atime), static_cast<int64_t>(st.st_mtime));
+}
+
+size_t walkTree(const std::string& root, const TreeVisitor& visit) {
+    size_t unreadable = 0;
+    std::vector<std::string> pending{root};
+    DirReader dir;
+    struct stat st{};
+    while (!pending.empty()) {
+        std::string path = std::move(pending.back());
+        pending.pop_back();
+        if (!dir.open(path.c_str())) {
+            ++unreadable;
+            continue;
+        }
+        if (path.back() != '/') path += '/';
+
+        DirReader::Entry child{};
+        while (dir.next(child)) {
+            if (!statAt(dir.fd(), child.name.data(), st)) continue;
+            visit(path, child.name, st);
+            if (S_ISDIR(st.st_mode)) pending.push_back(path + std::string(child.name));
+        }
+        if (dir.failed()) ++unreadable;
+        dir.close();
+    }
+    return unreadable;
+}
+
+bool parseSize(const std::string_view text, uint64_t& bytes) {
+    // strtod, not from_chars: libc++ on macOS has no floating-point from_chars.
+    const std::string copy(text);
+    if (copy.empty() || !(std::isdigit(static_cast<unsigned char>(copy.front())) || copy.front() == '.')) return false;
+    char* end = nullptr;
+    const double value = std::strtod(copy.c_str(), &end);
+    if (end == copy.c_str() || !std::isfinite(value) || value < 0) return false;
+
+    std::string_view unit(end);
+    if (unit.size() > 1 && (unit.back() == 'B' || unit.back() == 'b')) unit.remove_suffix(1);
+    int shift;
+    if (unit.empty() || unit == "B" || unit == "b") shift = 0;
+    else if (unit == "K" || unit == "k") shift = 10;
+    else if (unit == "M" || unit == "m") shift = 20;
+    else if (unit == "G" || unit == "g") shift = 30;
+    else if (unit == "T" || unit == "t") shift = 40;
+    else return false;
+
+    // Anything past 2^63 bytes is more than any disk; saturate rather than overflow.
+    const double scaled = std::ldexp(value, shift);
+    bytes = scaled >= std::ldexp(1.0, 63) ? std::numeric_limits<uint64_t>::max() / 2
+                                          : static_cast<uint64_t>(std::llround(scaled));
+    return true;
+}
+
+bool parseAge(const std::string_view text, int64_t& seconds) {
+    int64_t value = 0;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || value < 0) return false;
+
+    const std::string_view unit(end, static_cast<size_t>(text.data() + text.size() - end));
+    int64_t scale;
+    if (unit == "s") scale = 1;
+    else if (unit == "m") scale = 60;
+    else if (unit == "h") scale = 3600;
+    else if (unit.empty() || unit == "d") scale = 86400;
+    else if (unit == "w") scale = 7 * 86400;
+    else return false;
+
+    seconds = value > std::numeric_limits<int64_t>::max() / scale ? std::numeric_limits<int64_t>::max() : value * scale;
+    return true;
+}
+
+CacheCatalog::CacheCatalog() {
+    useDefaults();
+}
+
+void CacheCatalog::useDefaults() {
+    targets.clear();
+    loadedFrom.clear();
+    size_t start = 0;
+    while (start < kDefaultRules.size()) {
+        const size_t end = std::min(kDefaultRules.find('\n', start), kDefaultRules.size());
+        addRule(kDefaultRules.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+bool CacheCatalog::addRule(const std::string_view line) {
+    const std::vector<std::string> words = tokens(line.substr(0, line.find('#')));
+    if (words.empty()) return true;
+    if (words.size() < 2) return false;
+
+    CacheRule rule{unescape(words[0]), {}, 0, 0};
+    for (size_t i = 1; i < words.size(); ++i) {
+        const std::string_view word = words[i];
+        if (word.starts_with("age=")) {
+            if (!parseAge(word.substr(4), rule.minAge)) return false;
+        } else if (word.starts_with("min=")) {
+            if (!parseSize(word.substr(4), rule.minSize)) return false;
+        } else if (word.starts_with("/") || word == "~" || word.starts_with("~/")) {
+            rule.globs.emplace_back(word);
+        } else {
+            return false;
+        }
+    }
+    if (rule.globs.empty()) return false;
+
+    if (const size_t existing = find(rule.key); existing != targets.size()) {
+        CacheRule& target = targets[existing];
+        target.globs.insert(target.globs.end(), rule.globs.begin(), rule.globs.end());
+        target.minAge = rule.minAge;
+        target.minSize = rule.minSize;
+    } else {
+        targets.push_back(std::move(rule));
+    }
+    return true;
+}
+
+bool CacheCatalog::loadFile(const std::string& path, const bool mustExist) {
+    std::ifstream file(path);
+    if (!file.is_open()) return !mustExist;
+
+    targets.clear();
+    loadedFrom = path;
+    bool ok = true;
+    std::string line;
+    while (std::getline(file, line)) ok = addRule(line) && ok;
+    return ok;
+}
+
+std::string CacheCatalog::defaultConfigPath() {
+    if (const char* xdg = getenv("XDG_CONFIG_HOME"); xdg && *xdg) return std::string(xdg) + "/cliutils/caches";
+    if (const char* home = getenv("HOME"); home && *home) return std::string(home) + "/.config/cliutils/caches";
+    return {};
+}
+
+size_t CacheCatalog::find(const std::string_view key) const {
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (targets[i].key == key) return i;
+    }
+    return targets.size();
+}
+
+std::string CacheCatalog::folderOf(const size_t rule) const {
+    std::string glob = targets[rule].globs.front();
+    if (glob.ends_with("/*")) glob.resize(glob.size() - 1);
+    if (hasWildcard(glob)) return {};
+    std::string folder = unescape(expandHome(glob));
+    if (!folder.empty() && folder.back() != '/') folder += '/';
+    return folder;
+}
+
+std::vector<std::string> CacheCatalog::expand(const size_t rule) const {
+    std::vector<std::string> found;
+    struct stat st{};
+
+    for (const auto& glob : targets[rule].globs) {
+        const std::string pattern = expandHome(glob);
+        if (pattern.empty() || pattern.front() != '/') continue;
+
+        // Walk one segment at a time; only wildcard segments list a directory.
+        std::vector<std::string> current{""};
+        size_t start = 1;
+        while (start <= pattern.size() && !current.empty()) {
+            const size_t slash = std::min(pattern.find('/', start), pattern.size());
+            const std::string_view segment = std::string_view(pattern).substr(start, slash - start);
+            start = slash + 1;
+            if (segment.empty()) continue;
+
+            std::vector<std::string> next;
+            if (!hasWildcard(segment)) {
+                for (auto& base : current) next.push_back(base + "/" + unescape(segment));
+            } else {
+                DirReader dir;
+                DirReader::Entry entry{};
+                for (const auto& base : current) {
+                    if (!dir.open(base.empty() ? "/" : base.c_str())) continue;
+                    while (dir.next(entry)) {
+                        if (IgnoreRules::globMatch(segment, entry.name)) next.push_back(base + "/" + std::string(entry.name));
+                    }
+                    dir.close();
+                }
+            }
+            current = std::move(next);
+        }
+
+        for (auto& path : current) {
+            if (!path.empty() && lstat(path.c_str(), &st) == 0) found.push_back(std::move(path));
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    return found;
+}
+
+std::vector<std::vector<std::string>> CacheCatalog::claim() const {
+    std::vector<std::vector<std::string>> owned(targets.size());
+    std::unordered_set<std::string> claimed;
+    auto isClaimed = [&claimed](const std::string& path) {
+        for (size_t end = path.size(); end != std::string::npos && end > 0; end = path.rfind('/', end - 1)) {
+            if (claimed.contains(path.substr(0, end))) return true;
+        }
+        return false;
+    };
+    // expand() sorts, so within a rule an entry comes before what is inside it.
+    for (size_t i = 0; i < targets.size(); ++i) {
+        for (auto& path : expand(i)) {
+            if (isClaimed(path)) continue;
+            claimed.insert(path);
+            owned[i].push_back(std::move(path));
+        }
+    }
+    return owned;
+}
+
+std::vector<CacheReport> CacheCatalog::scan(const size_t threads) {
+    scanned = 0;
+    seen = 0;
+
+    std::vector<CacheReport> reports(targets.size());
+    std::vector<std::vector<std::string>> owned = claim();
+    for (size_t i = 0; i < targets.size(); ++i) {
+        reports[i].rule = i;
+        for (auto& path : owned[i]) reports[i].entries.push_back({std::move(path), 0, 0, 0, 0});
+    }
+
+    std::vector<size_t> tasks(targets.size());
+    for (size_t i = 0; i < tasks.size(); ++i) tasks[i] = i;
+
+    const auto now = static_cast<int64_t>(std::time(nullptr));
+    WorkStealingPool<size_t> pool(threads);
+    pool.run(tasks, [&](size_t, const size_t& i) {
+        CacheReport& report = reports[i];
+        for (auto& entry : report.entries) {
+            measure(entry, report.unreadable, seen);
+            report.allocated += entry.allocated;
+            if (now - entry.lastUsed >= targets[i].minAge) report.reclaimable += entry.allocated;
+        }
+        scanned.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    std::erase_if(reports, [this](const CacheReport& r) {
+        return r.entries.empty() || r.reclaimable < targets[r.rule].minSize;
+    });
+    std::sort(reports.begin(), reports.end(), [this](const CacheReport& a, const CacheReport& b) {
+        if (a.reclaimable != b.reclaimable) return a.reclaimable > b.reclaimable;
+        if (a.allocated != b.allocated) return a.allocated > b.allocated;
+        return targets[a.rule].key < targets[b.rule].key;
+    });
+    return reports;
+}
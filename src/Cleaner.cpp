@@ -3,72 +3,110 @@
 //
 
 #include "Cleaner.h"
+#include "DiskUsage.h"
+#include "DuplicateFinder.h"
+#include "EvictionPlanner.h"
+#include "TreeRemover.h"
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <filesystem>
 #include <algorithm>
-#include <dirent.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <numeric>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+std::string Cleaner::getFolder() const {
+    std::string keys;
+    for (size_t i = 0; i < catalog.rules().size(); ++i) {
+        if (catalog.folderOf(i).empty()) continue;
+        keys += (keys.empty() ? "" : ", ") + catalog.rules()[i].key;
+    }
 
-std::string Cleaner::getFolder() {
     std::string inputFolder;
-    std::cout << '\n' << colorText(BWhite, centered("Write Folder [cache, xCode, safari]: ", termWidth()));
+    std::cout << '\n' << colorText(BWhite, centered("Write Folder [" + keys + "]: ", termWidth()));
     std::getline(std::cin, inputFolder);
     return toLower(inputFolder);
 }
 
-std::string Cleaner::resolveFolderPath(const std::string& key) {
-    const char* homeDir = getenv("HOME");
-    if (!homeDir) {
-        return colorText(BRed, "Couldn't identify the home directory.\n");
+std::string Cleaner::resolveFolderPath(const std::string& key) const {
+    const size_t rule = catalog.find(key);
+    return rule < catalog.rules().size() ? catalog.folderOf(rule) : "";
+}
+
+constexpr size_t kPageSize = 50;
+
+std::string formatTime(const time_t t) {
+    char buf[64];
+    strftime(buf, sizeof(buf), "%a %b %d %H:%M:%S %Y", localtime(&t));
+    return std::string(buf);
+}
+
+static std::string formatStats(const ListedEntry::Kind kind, const uint64_t size, const time_t mtime) {
+    std::ostringstream oss;
+
+    switch (kind) {
+        case ListedEntry::Kind::Dir:  oss << colorText(BBlue, "[DIR] "); break;
+        case ListedEntry::Kind::File: oss << colorText(BGreen, "[FILE] "); break;
+        default:                      oss << colorText(BYellow, "[OTHER] "); break;
     }
 
-    if (key == "cache") return static_cast<std::string>(homeDir) + "/Library/Caches/";
-    if (key == "xcode") return static_cast<std::string>(homeDir) + "/Library/Developer/Xcode/DerivedData/";
-    if (key == "safari") return static_cast<std::string>(homeDir) + "/Library/Safari/LocalStorage/";
-    return "";
+    oss << colorText(BWhite, "Size: ") << colorText(BBlue, std::to_string(size) + " bytes  ")
+        << colorText(BWhite,"Modified: ") << colorText(BBlue, formatTime(mtime)) + "  ";
+
+    return oss.str();
+}
+
+static const char* orderName(const DirListing::Order order) {
+    switch (order) {
+        case DirListing::Order::Size: return "size";
+        case DirListing::Order::Age:  return "age";
+        default:                      return "name";
+    }
+}
+
+// Rows are formatted here, one page at a time; the listing itself holds numbers only.
+static void printPage(const std::string& folder, const DirListing& listing, const size_t first) {
+    const size_t last = std::min(listing.size(), first + kPageSize);
+    for (size_t i = first; i < last; ++i) {
+        const ListedEntry& entry = listing[i];
+        const std::string_view name = listing.name(i);
+        std::cout << colorText(BCyan, std::string(name))
+                  << std::string(name.size() < 70 ? 70 - name.size() : 1, ' ')
+                  << (entry.kind == ListedEntry::Kind::Unreadable
+                          ? colorText(BRed, "Cannot stat file: " + folder + std::string(name))
+                          : formatStats(entry.kind, entry.size, static_cast<time_t>(entry.mtime)))
+                  << '\n';
+    }
+
+    if (listing.size() > kPageSize) {
+        std::cout << '\n' << colorText(BWhite, centered(std::to_string(first + 1) + "-" + std::to_string(last) + " of "
+                                                         + std::to_string(listing.size()) + " entries, sorted by "
+                                                         + orderName(listing.order()), termWidth())) << '\n';
+    }
 }
 
 void Cleaner::printFileInFolder(const std::string& folder) {
-    DIR* dir = opendir(folder.c_str());
     std::cout << colorText(BRed, "\nDirectory: " + folder) << "\n\n" << std::string(termWidth(), '-') << '\n';
 
-    if (!dir) {
+    DirListing& listing = listings[folder];
+    if (!listing.read(folder)) {
         std::cerr << colorText(BRed, "Cannot open directory: " + folder) << '\n';
         return;
     }
 
-    struct dirent* entry;
-    std::vector<std::string> names;
-    while ((entry = readdir(dir)) != nullptr) {
-        if (std::string name = entry->d_name; name != "." && name != "..") {
-            names.push_back(name);
-            removeEntries[folder][name] = getStats(folder + name);
-        }
-    }
-    closedir(dir);
-
-    if (names.empty()) {
+    if (listing.empty()) {
         std::cout << colorText(BYellow, "\nDirectory is empty.\n");
     }
 
-    std::sort(names.begin(), names.end());
-
-    for (const auto& name : names) {
-        std::string stats = getStats(folder + name);
-        std::cout << colorText(BCyan, name)
-                  << std::string(70 - name.size(), ' ')
-                  << stats << '\n';
-    }
-}
-
-std::string formatTime(const time_t t) {
-    char buf[64];
-    strftime(buf, sizeof(buf), "%a %b %d %H:%M:%S %Y", localtime(&t));
-    return std::string(buf);
+    printPage(folder, listing, 0);
 }
 
 bool Cleaner::confirmation(const std::string& text) {
@@ -85,7 +123,71 @@ bool Cleaner::confirmation(const std::string& text) {
     }
 }
 
-void Cleaner::execute([[maybe_unused]] const std::vector<std::string>& args) {
+bool Cleaner::parseArgs(const std::vector<std::string>& args) {
+    rescan = false;
+    rulesFile.clear();
+    freeTarget = 0;
+    freeKeys.clear();
+    assumeYes = false;
+    dryRun = false;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            try {
+                const unsigned long value = std::stoul(args[++i]);
+                if (value == 0) throw std::invalid_argument("zero");
+                threads = value;
+            } catch (const std::exception&) {
+                std::cerr << colorText(BRed, "\n--threads expects a positive number\n");
+                return false;
+            }
+        } else if (args[i] == "--rescan") {
+            rescan = true;
+        } else if (args[i] == "--rules" && i + 1 < args.size()) {
+            rulesFile = args[++i];
+        } else if (args[i] == "--free" && i + 1 < args.size()) {
+            if (!parseSize(args[++i], freeTarget) || freeTarget == 0) {
+                std::cerr << colorText(BRed, "\n--free expects a size such as 20G or 500M\n");
+                return false;
+            }
+        } else if (args[i] == "--targets" && i + 1 < args.size()) {
+            freeKeys = args[++i];
+        } else if (args[i] == "--yes") {
+            assumeYes = true;
+        } else if (args[i] == "--dry-run") {
+            dryRun = true;
+        } else {
+            std::cerr << colorText(BRed, "\nUnknown option: " + args[i] + "\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+void Cleaner::execute(const std::vector<std::string>& args) {
+    status = 0;
+    if (!parseArgs(args)) {
+        status = 1;
+        return;
+    }
+    // Only the default rule file may be absent; one named with --rules must load.
+    catalog.useDefaults();
+    if (!rulesFile.empty()) {
+        if (!catalog.loadFile(rulesFile, true)) {
+            std::cerr << colorText(BRed, "\nCache rules in " + rulesFile + " could not be read\n");
+            status = 1;
+            return;
+        }
+    } else if (const std::string path = CacheCatalog::defaultConfigPath(); !path.empty() && !catalog.loadFile(path)) {
+        std::cerr << colorText(BRed, "\nSome cache rules in " + path + " could not be read\n");
+    }
+
+    // Straight to the plan, no menu: this is what cron runs.
+    if (freeTarget > 0) {
+        if (!evict(freeTarget, freeKeys)) status = 1;
+        return;
+    }
+
     clearScreen();
     for (size_t i = 0; i < 9; ++i) std::cout << '\n';
 
@@ -95,6 +197,16 @@ void Cleaner::execute([[maybe_unused]] const std::vector<std::string>& args) {
         "Commands:",
         "  1  - Cache Info & Management (view and delete cache files)",
         "  2  - Large Directory Scan (view size, optionally remove files)",
+        "  3  - Duplicate Files (find identical files, optionally remove copies)",
+        "  4  - Cache Report (reclaimable space per cache target)",
+        "  5  - Free Space (delete least recently used cache files up to a size)",
+        "",
+        "Options:",
+        "  --threads N - scan with N worker threads (default: all cores)",
+        "  --rescan    - list every directory again instead of trusting the size index",
+        "  --rules F   - read cache targets from F (default: ~/.config/cliutils/caches)",
+        "  --free SIZE - plan and delete the least recently used cache files, then exit",
+        "                (--targets k1,k2 to limit, --dry-run to only plan, --yes for cron)",
         "",
         "Navigation:",
         "  q, quit - go back to main menu"
@@ -113,6 +225,9 @@ void Cleaner::execute([[maybe_unused]] const std::vector<std::string>& args) {
             switch (std::stoi(input)) {
                 case 1: getAllInfo(); break;
                 case 2: largeDirectory(); break;
+                case 3: duplicateFiles(); break;
+                case 4: cacheReport(); break;
+                case 5: freeSpace(); break;
                 default: std::cout << '\n' << colorText(BRed, centered("Wrong input!\n", termWidth())); continue;
             }
         } catch (const std::invalid_argument&) {
@@ -128,42 +243,35 @@ void Cleaner::getAllInfo() {
         return;
     }
 
-    const std::vector<std::string> folders = {
-        static_cast<std::string>(homeDir) + "/Library/Caches/",
-        static_cast<std::string>(homeDir) + "/Library/Developer/Xcode/DerivedData/",
-        static_cast<std::string>(homeDir) + "/Library/Safari/LocalStorage/"
-    };
+    // Folders of the cache targets that exist here; the rest would only say "No such file".
+    std::vector<std::string> folders;
+    for (size_t i = 0; i < catalog.rules().size(); ++i) {
+        const std::string folder = catalog.folderOf(i);
+        struct stat st{};
+        if (!folder.empty() && stat(folder.c_str(), &st) == 0 && S_ISDIR(st.st_mode)
+            && std::find(folders.begin(), folders.end(), folder) == folders.end()) {
+            folders.push_back(folder);
+        }
+    }
+    if (folders.empty()) {
+        std::cout << '\n' << colorText(BYellow, centered("None of the cache folders exist.\n", termWidth()));
+        return;
+    }
 
-    std::map<std::string, std::string> entries;
     for (const auto& folder : folders) {
-        entries.clear();
-        DIR* dir = opendir(folder.c_str());
         std::cout << colorText(BRed, "\nDirectory: " + folder) << "\n\n" << std::string(termWidth(), '-') << '\n';
 
-        if (!dir) {
+        DirListing& listing = listings[folder];
+        if (!listing.read(folder)) {
             std::cout << colorText(BRed, "\nNo such file or directory") << '\n';
             continue;
         }
 
-        struct dirent* entry;
-        while ((entry = readdir(dir)) != nullptr) {
-            if (std::string name = entry->d_name; name != "." && name != "..") {
-                entries[name] = getStats(folder + name);
-                allEntries[folder][name] = getStats(folder + name);
-            }
-        }
-        closedir(dir);
-
-        if (entries.empty()) {
+        if (listing.empty()) {
             std::cout << colorText(BYellow, "\nDirectory is empty.\n\n");
         }
 
-        for (const auto& [filename, stats] : entries) {
-            std::cout << std::left
-                      << colorText(BCyan, filename)
-                      << std::string(70 - filename.size(), ' ')
-                      << stats << '\n';
-        }
+        printPage(folder, listing, 0);
         std::cout << std::string(termWidth(), '-') << '\n';
     }
 
@@ -176,18 +284,10 @@ std::string Cleaner::getStats(const std::string& path) const {
         return colorText(BRed, "Cannot stat file: " + path);
     }
 
-    std::ostringstream oss;
-
-    switch (st.st_mode & S_IFMT) {
-        case S_IFDIR: oss << colorText(BBlue, "[DIR] "); break;
-        case S_IFREG: oss << colorText(BGreen, "[FILE] "); break;
-        default:      oss << colorText(BYellow, "[OTHER] "); break;
-    }
-
-    oss << colorText(BWhite, "Size: ") << colorText(BBlue, std::to_string(st.st_size) + " bytes  ")
-        << colorText(BWhite,"Modified: ") << colorText(BBlue, formatTime(st.st_mtime)) + "  ";
-
-    return oss.str();
+    ListedEntry::Kind kind = ListedEntry::Kind::Other;
+    if (S_ISDIR(st.st_mode)) kind = ListedEntry::Kind::Dir;
+    else if (S_ISREG(st.st_mode)) kind = ListedEntry::Kind::File;
+    return formatStats(kind, static_cast<uint64_t>(st.st_size), st.st_mtime);
 }
 
 void Cleaner::removeFile() {
@@ -203,36 +303,53 @@ void Cleaner::removeFile() {
     }
 
     printFileInFolder(workFolder);
+    DirListing& listing = listings[workFolder];
+    size_t first = 0;
 
     while (true) {
-        std::cout << '\n' << colorText(BWhite, centered("Enter filename to remove or 'quit' for Exit: ", termWidth()));
+        std::cout << '\n' << colorText(BWhite, centered("Enter filename to remove, 'next' / 'prev' / 'size' / 'age' / 'name' "
+                                                         "to browse or 'quit' for Exit: ", termWidth()));
         std::string input;
         std::getline(std::cin, input);
         std::string inputLower = toLower(input);
 
         if (inputLower == "quit") return;
 
+        if (inputLower == "next" || inputLower == "prev" || inputLower == "size" || inputLower == "age" || inputLower == "name") {
+            if (inputLower == "next") {
+                if (first + kPageSize < listing.size()) first += kPageSize;
+            } else if (inputLower == "prev") {
+                first = first >= kPageSize ? first - kPageSize : 0;
+            } else {
+                listing.sort(inputLower == "size" ? DirListing::Order::Size
+                           : inputLower == "age"  ? DirListing::Order::Age
+                                                  : DirListing::Order::Name);
+                first = 0;
+            }
+            std::cout << '\n';
+            printPage(workFolder, listing, first);
+            continue;
+        }
+
         bool exactFound = false;
         std::vector<std::string> matches;
 
-        for (const auto& [filename, _] : removeEntries[workFolder]) {
-            std::string filenameLower = filename;
-            filenameLower = toLower(filenameLower);
+        for (size_t i = 0; i < listing.size(); ++i) {
+            std::string filenameLower = toLower(std::string(listing.name(i)));
 
             if (filenameLower == inputLower) {
-                matches = { filename };
+                matches = { std::string(listing.name(i)) };
                 exactFound = true;
                 break;
             }
         }
 
         if (!exactFound) {
-            for (const auto& [filename, _] : removeEntries[workFolder]) {
-                std::string filenameLower = filename;
-                filenameLower = toLower(filenameLower);
+            for (size_t i = 0; i < listing.size(); ++i) {
+                std::string filenameLower = toLower(std::string(listing.name(i)));
 
                 if (filenameLower.find(inputLower) != std::string::npos) {
-                    matches.push_back(filename);
+                    matches.push_back(std::string(listing.name(i)));
                 }
             }
         }
@@ -243,12 +360,17 @@ void Cleaner::removeFile() {
         } else if (matches.size() == 1) {
             std::cout << '\n' << colorText(BWhite, centered(("Find file: " + matches[0]), termWidth())) << '\n';
             if (confirmation("Are you sure? [y/n]: ")) {
-                std::filesystem::is_directory(workFolder)
-                    ? std::filesystem::remove_all((workFolder + matches[0]).c_str())
-                    : std::filesystem::remove((workFolder + matches[0]).c_str());
-
-                removeEntries.erase(matches[0]);
-                std::cout << '\n' << colorText(BGreen, centered("File was deleted.\n", termWidth()));
+                TreeRemover remover;
+                removeWithProgress(remover, workFolder + matches[0], 0);
+                if (remover.removed()) {
+                    for (size_t i = 0; i < listing.size(); ++i) {
+                        if (listing.name(i) == matches[0]) {
+                            listing.erase(i);
+                            break;
+                        }
+                    }
+                    std::cout << '\n' << colorText(BGreen, centered("File was deleted.\n", termWidth()));
+                }
             }
             break;
         } else {
@@ -264,6 +386,10 @@ double bytesToGb(const long long bytes) {
     return bytes / (1024.0 * 1024.0 * 1024.0);
 }
 
+double bytesToMb(const long long bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
 std::string roundGb(const double size) {
     std::stringstream ss;
     ss << std::fixed << std::setprecision(2) << size;
@@ -288,12 +414,12 @@ double getUserSize() {
     }
 }
 
-int getUserDelNum() {
+int getUserDelNum(const std::string& prompt) {
     std::string input;
     int userNumber = 0;
 
     while (true) {
-        std::cout << '\n' << colorText(BWhite, centered("Enter the number of the directory to delete or 'q/quit' to exit: ", termWidth()));
+        std::cout << '\n' << colorText(BWhite, centered(prompt, termWidth()));
 
         std::getline(std::cin, input);
         std::stringstream ss(input);
@@ -310,93 +436,499 @@ int getUserDelNum() {
     }
 }
 
+static std::string progressLine(const DiskUsage& usage, const double seconds) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(0)
+         << "Scanned " << usage.dirsScanned() << " dirs (" << usage.dirsScanned() / std::max(seconds, 0.001)
+         << " dirs/s), ";
+    if (usage.dirsReused() > 0) line << usage.dirsReused() << " unchanged, ";
+    line << std::setprecision(2) << bytesToGb(static_cast<long long>(usage.bytesScanned())) << " GB seen";
+    return line.str();
+}
+
+static std::string duplicateLine(const DuplicateFinder& finder) {
+    std::ostringstream line;
+    switch (finder.stage()) {
+        case DuplicateFinder::Stage::Walking:
+            line << "Walked " << finder.filesSeen() << " files";
+            break;
+        case DuplicateFinder::Stage::Sampling:
+            line << "Sampling " << finder.hashed() << " / " << finder.toHash() << " same-size files";
+            break;
+        case DuplicateFinder::Stage::Hashing:
+            line << "Hashing " << finder.hashed() << " / " << finder.toHash() << " candidates";
+            break;
+        case DuplicateFinder::Stage::Done:
+            line << "Checked " << finder.filesSeen() << " files, " << finder.groups().size() << " duplicate groups";
+            break;
+    }
+    return line.str();
+}
+
+static std::string removalBar(const TreeRemover& remover, const uint64_t expectedBytes, const size_t step) {
+    constexpr size_t width = 20;
+    std::string bar;
+    if (expectedBytes > 0) {
+        const size_t filled = static_cast<size_t>(std::min<uint64_t>(width, remover.bytesFreed() * width / expectedBytes));
+        for (size_t i = 0; i < width; ++i) bar += i < filled ? "█" : "-";
+    } else {
+        // Size unknown: a block that bounces back and forth.
+        const size_t at = step % (2 * width - 2) < width ? step % (2 * width - 2) : 2 * width - 2 - step % (2 * width - 2);
+        for (size_t i = 0; i < width; ++i) bar += i == at ? "█" : "-";
+    }
+    return bar;
+}
+
+static std::string removalLine(const TreeRemover& remover, const uint64_t expectedBytes, const double seconds) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(0);
+    if (expectedBytes > 0) line << std::min<uint64_t>(100, remover.bytesFreed() * 100 / expectedBytes) << "%  ";
+    line << remover.filesRemoved() << " files (" << remover.filesRemoved() / std::max(seconds, 0.001) << " files/s), "
+         << std::setprecision(2) << bytesToGb(static_cast<long long>(remover.bytesFreed())) << " GB freed";
+    return line.str();
+}
+
+// The work runs on the pool; this thread only redraws one status line.
+static bool runWithProgress(const std::function<std::string(double)>& status, const std::function<bool()>& work) {
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool done = false;
+    const auto started = std::chrono::steady_clock::now();
+    auto elapsed = [&started] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+
+    std::cout << '\n';
+    std::thread progress([&] {
+        std::unique_lock lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::milliseconds(200), [&done] { return done; })) {
+            std::cout << "\r\033[K" << colorText(BYellow, centered(status(elapsed()), termWidth())) << std::flush;
+        }
+    });
+
+    const bool ok = work();
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    wake.notify_one();
+    progress.join();
+
+    std::cout << "\r\033[K" << colorText(BYellow, centered(status(elapsed()), termWidth())) << '\n';
+    return ok;
+}
+
+static std::string formatAge(const int64_t seconds) {
+    if (seconds <= 0) return "-";
+    if (seconds % 86400 == 0) return std::to_string(seconds / 86400) + "d";
+    if (seconds % 3600 == 0) return std::to_string(seconds / 3600) + "h";
+    if (seconds % 60 == 0) return std::to_string(seconds / 60) + "m";
+    return std::to_string(seconds) + "s";
+}
+
+static std::string formatSize(const uint64_t bytes) {
+    const auto value = static_cast<long long>(bytes);
+    return bytes < (uint64_t{1} << 30) ? roundGb(bytesToMb(value)) + " MB" : roundGb(bytesToGb(value)) + " GB";
+}
+
+static std::string formatDay(const int64_t t) {
+    const auto time = static_cast<time_t>(t);
+    char buf[16];
+    strftime(buf, sizeof(buf), "%Y-%m-%d", localtime(&time));
+    return std::string(buf);
+}
+
+static void reportUnreadable(const size_t count, const std::string& what) {
+    if (count == 0) return;
+    std::cout << colorText(BYellow, centered(std::to_string(count) + " " + what + " could not be read", termWidth())) << '\n';
+}
+
 void Cleaner::largeDirectory() {
     const double userSize = getUserSize();
 
-    std::cout << '\n' << colorText(BYellow, centered("Please wait (about 1 minute), calculating sizes...", termWidth())) << std::endl;
-
     const char* homeDir = getenv("HOME");
     if (!homeDir) {
         std::cerr << colorText(BRed, "Couldn't identify the home directory.") << '\n';
         return;
     }
 
-    std::map<fs::path, long long> dirSizes;
-    for (fs::recursive_directory_iterator it(homeDir, fs::directory_options::skip_permission_denied), end;
-         it != end; ) {
-        try {
-            if (it->is_regular_file()) {
-                dirSizes[it->path()] = it->file_size();
-            }
-            ++it;
-        } catch(const fs::filesystem_error&) {
-            it.disable_recursion_pending();
-            ++it;
-        }
+    DiskUsage usage;
+    const std::string indexPath = DiskUsage::defaultIndexPath(homeDir);
+    const bool scanned = runWithProgress(
+        [&usage](const double seconds) { return progressLine(usage, seconds); },
+        [&] { return usage.scan(homeDir, threads, rescan ? "" : indexPath); });
+    if (!scanned) {
+        std::cerr << colorText(BRed, "Cannot open directory: " + std::string(homeDir)) << '\n';
+        return;
     }
-
-    std::map<fs::path, long long> totalSizes;
-    for (const auto& [path, size] : dirSizes) {
-        fs::path p = path.parent_path();
-        while (!p.empty() && p.string().find(homeDir) == 0) {
-            totalSizes[p] += size;
-            p = p.parent_path();
-        }
+    reportUnreadable(usage.unreadable(), "directories");
+    if (!usage.saveIndex(indexPath)) {
+        std::cerr << colorText(BRed, "Cannot write the size index: " + indexPath) << '\n';
     }
 
+    // Filtered and ranked by what deleting would free: allocated blocks.
+    // Rebuilt from the scan after every deletion, no rescan needed.
+    std::vector<uint32_t> large;
     std::vector<Row> rows;
-    rows.push_back({"№", "Directory", "Size (Gb)", ""});
+    auto showTable = [&] {
+        large.clear();
+        for (uint32_t id = 0; id < usage.size(); ++id) {
+            if (usage[id].files > 0 && bytesToGb(static_cast<long long>(usage[id].allocated)) >= userSize) large.push_back(id);
+        }
+        std::sort(large.begin(), large.end(), [&usage](const uint32_t a, const uint32_t b) {
+            return usage[a].allocated != usage[b].allocated ? usage[a].allocated > usage[b].allocated
+                                                            : usage.path(a) < usage.path(b);
+        });
 
-    for (const auto& [dir, size] : totalSizes) {
-        double sizeGb = bytesToGb(size);
-        if (sizeGb >= userSize) {
+        rows.clear();
+        rows.push_back({"№", "Directory", "On disk (Gb)", "Apparent (Gb)", ""});
+
+        for (const uint32_t id : large) {
+            const std::string dir = usage.path(id);
             rows.push_back({
                 "0",
-                shortPath(dir.string()),
-                roundGb(sizeGb),
+                shortPath(dir),
+                roundGb(bytesToGb(static_cast<long long>(usage[id].allocated))),
+                roundGb(bytesToGb(static_cast<long long>(usage[id].bytes))),
                 dir
             });
         }
+
+        for (size_t i = 1; i < rows.size(); ++i) {
+            rows[i].index = std::to_string(i);
+        }
+
+        std::vector<std::vector<std::string>> outputDate;
+        for (const auto& r : rows) {
+            outputDate.push_back({r.index, r.shortPath, r.sizeDir, r.apparentDir});
+        }
+
+        std::cout << '\n';
+        printProcessTable(outputDate);
+    };
+    showTable();
+
+    if (!confirmation("Do you want to delete a directory? [y/n]: ")) return;
+
+    while (true) {
+        const int deleteNumber = getUserDelNum("Enter the number of the directory to delete or 'q/quit' to exit: ");
+        if (deleteNumber == 0) {
+            break;
+        }
+
+        if (deleteNumber <= 0 || deleteNumber >= static_cast<int>(rows.size())) {
+            std::cout << '\n' << colorText(BRed, centered("Invalid number!\n", termWidth()));
+            continue;
+        }
+
+        const uint32_t id = large[deleteNumber - 1];
+        const std::string shortDir = rows[deleteNumber].shortPath;
+
+        if (!confirmation("Are you sure? [y/n]: ")) return;
+
+        TreeRemover remover;
+        removeWithProgress(remover, rows[deleteNumber].fullPath.string(), usage[id].allocated);
+        if (remover.removed()) {
+            usage.erase(id);
+            std::cout << '\n' << colorText(BGreen, centered("File: '" + shortDir + "' was deleted.\n", termWidth()));
+        } else {
+            // Settle every directory below `id` the removal touched, so their
+            // rows shrink too and the ones already gone are not offered again.
+            std::unordered_map<std::string, const TreeRemover::RemovedDir*> touched;
+            for (const auto& dir : remover.removedDirs()) touched.emplace(dir.path, &dir);
+
+            std::vector<uint32_t> gone;
+            for (uint32_t other = 0; other < usage.size(); ++other) {
+                uint32_t up = other;
+                while (up != id && up != DiskUsage::kRoot) up = usage[up].parent;
+                if (up != id) continue;
+
+                const auto it = touched.find(usage.path(other));
+                if (it == touched.end()) continue;
+                usage.discount(other, it->second->bytes, it->second->freed, it->second->files);
+                if (it->second->gone) gone.push_back(other);
+            }
+            usage.erase(gone);
+        }
+        showTable();
     }
+}
 
-    std::sort(rows.begin() + 1, rows.end(), [](const Row& a, const Row& b) {
-        return std::stod(a.sizeDir) > std::stod(b.sizeDir);
-    });
+void Cleaner::duplicateFiles() {
+    constexpr size_t kShownGroups = 50;
 
-    for (size_t i = 1; i < rows.size(); ++i) {
-        rows[i].index = std::to_string(i);
+    const char* homeDir = getenv("HOME");
+    if (!homeDir) {
+        std::cerr << colorText(BRed, "Couldn't identify the home directory.") << '\n';
+        return;
     }
 
+    std::string root;
+    std::cout << '\n' << colorText(BWhite, centered("Enter folder to search (empty for home): ", termWidth()));
+    std::getline(std::cin, root);
+    if (root.empty()) root = homeDir;
+
+    DuplicateFinder finder;
+    const bool found = runWithProgress(
+        [&finder](double) { return duplicateLine(finder); },
+        [&] { return finder.find(root, threads); });
+    if (!found) {
+        std::cerr << colorText(BRed, "Cannot open directory: " + root) << '\n';
+        return;
+    }
+    reportUnreadable(finder.unreadable(), "files or directories");
+
+    if (finder.groups().empty()) {
+        std::cout << '\n' << colorText(BGreen, centered("No duplicate files found.\n", termWidth()));
+        return;
+    }
+
+    std::vector<DuplicateGroup> groups(finder.groups().begin(),
+                                       finder.groups().begin() + static_cast<ptrdiff_t>(std::min(kShownGroups, finder.groups().size())));
+    const uint64_t wasted = std::accumulate(finder.groups().begin(), finder.groups().end(), uint64_t{0},
+                                            [](const uint64_t sum, const DuplicateGroup& g) { return sum + g.wasted(); });
+
     std::vector<std::vector<std::string>> outputDate;
-    for (const auto& r : rows) {
-        outputDate.push_back({r.index, r.shortPath, r.sizeDir});
+    outputDate.push_back({"№", "Wasted (Mb)", "Copies", "Size (Mb)", "File"});
+    for (size_t i = 0; i < groups.size(); ++i) {
+        outputDate.push_back({
+            std::to_string(i + 1),
+            roundGb(bytesToMb(static_cast<long long>(groups[i].wasted()))),
+            std::to_string(groups[i].paths.size()),
+            roundGb(bytesToMb(static_cast<long long>(groups[i].size))),
+            shortPath(groups[i].paths.front())
+        });
     }
 
     std::cout << '\n';
     printProcessTable(outputDate);
+    std::cout << '\n' << colorText(BWhite, centered(std::to_string(finder.groups().size()) + " groups, "
+                                                     + roundGb(bytesToGb(static_cast<long long>(wasted)))
+                                                     + " GB in extra copies (largest " + std::to_string(groups.size())
+                                                     + " shown)", termWidth())) << '\n';
 
-    if (!confirmation("Do you want to delete a directory? [y/n]: ")) return;
+    if (!confirmation("Do you want to delete duplicates? [y/n]: ")) return;
 
     while (true) {
-        const int deleteNumber = getUserDelNum();
-        if (deleteNumber == 0) {
-            break;
+        const int groupNumber = getUserDelNum("Enter the number of the group or 'q/quit' to exit: ");
+        if (groupNumber == 0) break;
+        if (groupNumber < 0 || groupNumber > static_cast<int>(groups.size())) {
+            std::cout << '\n' << colorText(BRed, centered("Invalid number!\n", termWidth()));
+            continue;
         }
 
-        if (deleteNumber <= 0 || deleteNumber >= static_cast<int>(rows.size())) {
-            std::cout << '\n' << colorText(BRed, centered("Invalid number!\n", termWidth()));
+        DuplicateGroup& group = groups[groupNumber - 1];
+        std::vector<std::vector<std::string>> copies = {{"№", "File"}};
+        for (size_t i = 0; i < group.paths.size(); ++i) copies.push_back({std::to_string(i + 1), group.paths[i]});
+        std::cout << '\n';
+        printProcessTable(copies);
+
+        if (group.paths.size() < 2) {
+            std::cout << '\n' << colorText(BYellow, centered("Only one copy is left.\n", termWidth()));
             continue;
         }
 
-        const fs::path pathDelDir = rows[deleteNumber].fullPath;
+        const int copyNumber = getUserDelNum("Enter the number of the copy to delete or 'q/quit' to go back: ");
+        if (copyNumber == 0) continue;
+        if (copyNumber < 0 || copyNumber > static_cast<int>(group.paths.size())) {
+            std::cout << '\n' << colorText(BRed, centered("Invalid number!\n", termWidth()));
+            continue;
+        }
 
         if (!confirmation("Are you sure? [y/n]: ")) return;
 
-        try {
-            std::filesystem::remove_all(pathDelDir.c_str());
-            std::cout << '\n' << colorText(BGreen, centered("File: '" + rows[deleteNumber].shortPath + "' was deleted.\n", termWidth()));
-        } catch (const fs::filesystem_error&) {
+        const std::string path = group.paths[copyNumber - 1];
+        std::error_code ec;
+        if (std::filesystem::remove(path, ec)) {
+            group.paths.erase(group.paths.begin() + copyNumber - 1);
+            std::cout << '\n' << colorText(BGreen, centered("File: '" + shortPath(path) + "' was deleted.\n", termWidth()));
+        } else {
             std::cout << '\n' << colorText(BRed, centered("Error delete", termWidth()));
         }
     }
 }
+
+void Cleaner::cacheReport() {
+    std::vector<CacheReport> reports;
+    const size_t targets = catalog.rules().size();
+    runWithProgress(
+        [this, targets](const double seconds) {
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(2) << "Scanned " << catalog.targetsScanned() << " / " << targets
+                 << " cache targets, " << bytesToGb(static_cast<long long>(catalog.bytesScanned())) << " GB seen ("
+                 << std::setprecision(1) << seconds << " s)";
+            return line.str();
+        },
+        [&] { reports = catalog.scan(threads); return true; });
+    reportUnreadable(std::accumulate(reports.begin(), reports.end(), size_t{0},
+                                     [](const size_t sum, const CacheReport& r) { return sum + r.unreadable; }),
+                     "files or directories");
+
+    const std::string source = catalog.source().empty() ? "built-in rules" : "rules from " + shortPath(catalog.source());
+    if (reports.empty()) {
+        std::cout << '\n' << colorText(BGreen, centered("No cache targets found (" + source + ").\n", termWidth()));
+        return;
+    }
+
+    std::vector<std::vector<std::string>> outputDate;
+    outputDate.push_back({"№", "Target", "Reclaimable (Gb)", "On disk (Gb)", "Entries", "Unused for", "Path"});
+    uint64_t reclaimable = 0;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const CacheReport& report = reports[i];
+        const CacheRule& rule = catalog.rules()[report.rule];
+        reclaimable += report.reclaimable;
+        outputDate.push_back({
+            std::to_string(i + 1),
+            rule.key,
+            roundGb(bytesToGb(static_cast<long long>(report.reclaimable))),
+            roundGb(bytesToGb(static_cast<long long>(report.allocated))),
+            std::to_string(report.entries.size()),
+            formatAge(rule.minAge),
+            report.entries.size() == 1 ? shortPath(report.entries.front().path) : rule.globs.front()
+        });
+    }
+
+    std::cout << '\n';
+    printProcessTable(outputDate);
+    std::cout << '\n' << colorText(BWhite, centered(roundGb(bytesToGb(static_cast<long long>(reclaimable)))
+                                                     + " GB reclaimable in " + std::to_string(reports.size())
+                                                     + " targets (" + source + ")", termWidth())) << '\n';
+}
+
+void Cleaner::freeSpace() {
+    std::string input;
+    uint64_t target = 0;
+    while (true) {
+        std::cout << '\n' << colorText(BWhite, centered("Enter how much to free (e.g. 20G, 500M): ", termWidth()));
+        std::getline(std::cin, input);
+        if (input == "q" || input == "quit") return;
+        if (parseSize(input, target) && target > 0) break;
+        std::cout << '\n' << colorText(BRed, centered("Please enter a size!\n", termWidth()));
+    }
+
+    std::cout << '\n' << colorText(BWhite, centered("Targets, comma separated (empty for all): ", termWidth()));
+    std::getline(std::cin, input);
+    evict(target, input);
+}
+
+// Plans first and shows the plan; nothing is deleted before that.
+bool Cleaner::evict(const uint64_t target, const std::string& keys) {
+    std::vector<size_t> rules;
+    std::stringstream list(keys);
+    for (std::string key; std::getline(list, key, ',');) {
+        std::erase_if(key, [](const unsigned char c) { return std::isspace(c); });
+        if (key.empty()) continue;
+        const size_t rule = catalog.find(key);
+        if (rule == catalog.rules().size()) {
+            std::cerr << colorText(BRed, "\nUnknown cache target: " + key + "\n");
+            return false;
+        }
+        rules.push_back(rule);
+    }
+
+    EvictionPlanner planner;
+    EvictionPlan plan;
+    runWithProgress(
+        [&planner](const double seconds) {
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(0) << "Checked " << planner.filesSeen() << " files ("
+                 << planner.filesSeen() / std::max(seconds, 0.001) << " files/s)";
+            return line.str();
+        },
+        [&] { plan = planner.plan(catalog, rules, target, threads); return true; });
+    reportUnreadable(plan.unreadable, "directories");
+
+    if (plan.files.empty()) {
+        std::cout << '\n' << colorText(BGreen, centered("Nothing in the caches may be deleted.\n", termWidth()));
+        return false;
+    }
+
+    // One row per target: the plan itself can run to millions of files.
+    struct Share { size_t files = 0; uint64_t bytes = 0; int64_t oldest = 0; int64_t newest = 0; };
+    std::map<size_t, Share> shares;
+    for (const auto& file : plan.files) {
+        Share& share = shares[plan.ruleOf[file.entry]];
+        if (share.files++ == 0) share.oldest = file.lastUsed;
+        share.bytes += file.bytes;
+        share.newest = file.lastUsed;
+    }
+
+    std::vector<std::vector<std::string>> outputDate;
+    outputDate.push_back({"Target", "Files", "Frees (Mb)", "Oldest use", "Newest use"});
+    for (const auto& [rule, share] : shares) {
+        outputDate.push_back({
+            catalog.rules()[rule].key,
+            std::to_string(share.files),
+            roundGb(bytesToMb(static_cast<long long>(share.bytes))),
+            formatDay(share.oldest),
+            formatDay(share.newest)
+        });
+    }
+    std::cout << '\n';
+    printProcessTable(outputDate);
+
+    std::cout << '\n' << colorText(BWhite, centered("Plan frees " + formatSize(plan.bytes) + " of "
+                                                     + formatSize(plan.target) + " requested (" + std::to_string(plan.files.size()) + " of "
+                                                     + std::to_string(plan.considered) + " files)", termWidth())) << '\n';
+    if (!plan.reachesTarget()) {
+        std::cout << colorText(BYellow, centered("Only " + formatSize(plan.available)
+                                                 + " in the caches may be deleted.", termWidth())) << '\n';
+    }
+
+    if (dryRun) return plan.reachesTarget();
+    if (!assumeYes) {
+        if (!isatty(STDIN_FILENO)) {
+            std::cout << colorText(BYellow, centered("Nothing deleted: pass --yes to delete without a terminal.", termWidth())) << '\n';
+            return false;
+        }
+        if (!confirmation("Delete these files? [y/n]: ")) return false;
+    }
+
+    const size_t total = plan.files.size();
+    runWithProgress(
+        [&planner, total](double) {
+            return "Deleted " + std::to_string(planner.filesRemoved()) + " / " + std::to_string(total) + " files, "
+                 + formatSize(planner.bytesFreed()) + " freed";
+        },
+        [&] { planner.execute(plan); return true; });
+    if (planner.failures() > 0) {
+        std::cout << colorText(BRed, centered(std::to_string(planner.failures()) + " files could not be deleted",
+                                              termWidth())) << '\n';
+    }
+    return plan.reachesTarget() && planner.failures() == 0;
+}
+
+// Deletion runs on the remover's pool; this thread draws the bar and takes c / q to cancel.
+void Cleaner::removeWithProgress(TreeRemover& remover, const std::string& path, const uint64_t expectedBytes) const {
+    const auto started = std::chrono::steady_clock::now();
+    auto elapsed = [&started] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+    auto draw = [&](const size_t step) {
+        const std::string bar = removalBar(remover, expectedBytes, step);
+        const std::string text = removalLine(remover, expectedBytes, elapsed())
+                               + (remover.finished() || remover.cancelled() ? "" : "   c - cancel");
+        const int pad = std::max(0, (termWidth() - utf8Length(bar) - 1 - static_cast<int>(text.size())) / 2);
+        std::cout << "\r\033[K" << std::string(pad, ' ') << colorText(BGreen, bar) << ' ' << colorText(BYellow, text) << std::flush;
+    };
+
+    std::cout << '\n';
+    remover.start(path, threads);
+    for (size_t step = 0; !remover.finished(); ++step) {
+        if (const char c = getCharNonBlocking(); c == 'c' || c == 'q') remover.cancel();
+        draw(step);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    remover.wait();
+    draw(0);
+    std::cout << '\n';
+
+    if (remover.cancelled()) {
+        std::cout << colorText(BYellow, centered("Cancelled: " + std::to_string(remover.filesRemoved())
+                                                 + " files were already deleted.", termWidth())) << '\n';
+    }
+    if (remover.failures() > 0) {
+        std::cout << colorText(BRed, centered(std::to_string(remover.failures()) + " entries could not be deleted ("
+                                              + remover.firstError() + ")", termWidth())) << '\n';
+    }
+}
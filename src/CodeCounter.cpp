@@ -3,28 +3,29 @@
 //
 
 #include "CodeCounter.h"
+#include "LineCounter.h"
+#include "LineLexer.h"
+#include "GitIndex.h"
+#include "BatchReader.h"
+#include "DirTree.h"
+#include "TreeWatcher.h"
+#include "FileSniffer.h"
+#include "TarReader.h"
+#include "DirReader.h"
 #include <unordered_set>
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sys/stat.h>
 
 namespace fs = std::filesystem;
 
-void CodeCounter::initMap() {
-    languageMap = {
-        {"cpp", { {".h", ".hpp", ".tpp", ".cpp", ".cc", ".cxx"}, "C++"}},
-        {"java", { {".java"}, "Java"}},
-        {"python", { {".py"}, "Python"}},
-        {"js", { {".js", ".jsx"}, "JavaScript"}},
-        {"ts", { {".ts", ".tsx"}, "TypeScript"}},
-        {"cs", { {".cs"}, "C#"}},
-        {"go", { {".go"}, "Go"}},
-        {"rust", { {".rs"}, "Rust"}},
-        {"swift", { {".swift"}, "Swift"}},
-        {"kotlin", { {".kt", ".kts"}, "Kotlin"}},
-        {"php", { {".php"}, "PHP"}},
-        {"ruby", { {".rb"}, "Ruby"}},
-        {"assembly", { {".asm"}, "Assembly"}}
-    };
+CodeCounter::CodeCounter() {
+    if (const std::string config = LangTable::defaultConfigPath(); !config.empty() && !languages.loadFile(config)) {
+        std::cerr << colorText(BYellow, "\nSome languages in " + config + " could not be parsed\n");
+    }
+    configuredLanguages = languages;
 }
 
 std::string CodeCounter::inputFolder() {
@@ -33,7 +34,8 @@ std::string CodeCounter::inputFolder() {
     std::cout << '\n' << colorText(BWhite, centered("Write path to project Directory: ", termWidth()));
     std::getline(std::cin, folderPath);
 
-    if (!fs::exists(folderPath) || !fs::is_directory(folderPath)) {
+    const bool archive = TarReader::isArchive(folderPath) && fs::is_regular_file(folderPath);
+    if (!archive && (!fs::exists(folderPath) || !fs::is_directory(folderPath))) {
         std::cout << '\n' << colorText(BRed, centered("Invalid Path.", termWidth()));
         return "";
     }
@@ -42,39 +44,466 @@ std::string CodeCounter::inputFolder() {
 }
 
 size_t CodeCounter::countLine(const std::string& folderPath) {
-    std::ifstream file(folderPath);
-    if (!file.is_open()) return 0;
-
     size_t count = 0;
-    std::string line;
-    while (std::getline(file, line)) {
-        ++count;
-    }
-
+    readFile(folderPath, [&count](const std::string_view content) {
+        count = countLines(content);
+    });
     return count;
 }
 
-bool CodeCounter::isIgnorePath(const fs::path& path) {
-    static const std::unordered_set<std::string> ignored = {
+std::unique_ptr<LineCache> CodeCounter::openCache(const std::string& folderPath) const {
+    if (!useCache || TarReader::isArchive(folderPath)) return nullptr;
+    return std::make_unique<LineCache>(folderPath, languages.signature());
+}
+
+bool CodeCounter::isIgnoredName(const std::string_view name) {
+    static const std::unordered_set<std::string_view> ignored = {
         "cmake-build-debug", ".git", "build", "cmakefiles",
         ".vscode", ".idea", "node_modules", "__pycache__",
-        "venv", "__pycache__", "site-packages"
+        "venv", "site-packages", "activate_this.py"
     };
 
-    for (auto p : path) {
-        std::string folder = toLower(p.filename().string());
-        if (ignored.contains(folder) || folder.find("cmake") != std::string::npos) {
-            return true;
-        }
+    char lower[256];
+    if (name.size() > sizeof(lower)) return false;
+    for (size_t i = 0; i < name.size(); ++i) {
+        lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(name[i])));
     }
 
-    std::string filename = toLower(path.filename().string());
-    if (filename == "activate_this.py") return true;
+    const std::string_view folder(lower, name.size());
+    return ignored.contains(folder) || folder.find("cmake") != std::string_view::npos;
+}
 
+bool CodeCounter::isIgnorePath(const fs::path& path) {
+    for (const auto& p : path) {
+        if (isIgnoredName(p.native())) return true;
+    }
     return false;
 }
 
-void CodeCounter::execute([[maybe_unused]] const std::vector<std::string>& args) {
+std::shared_ptr<const IgnoreNode> CodeCounter::rootIgnore(const std::string& folderPath) const {
+    auto root = std::make_shared<IgnoreNode>();
+
+    std::vector<std::string> files = ignoreFiles;
+    if (const char* xdg = getenv("XDG_CONFIG_HOME"); xdg && *xdg) {
+        files.push_back(std::string(xdg) + "/cliutils/ignore");
+    } else if (const char* home = getenv("HOME"); home && *home) {
+        files.push_back(std::string(home) + "/.config/cliutils/ignore");
+    }
+    if (useIgnoreFiles) {
+        if (const std::string gitDir = GitIndex::indexPath(folderPath); !gitDir.empty()) {
+            files.push_back(GitIndex::commonDir(gitDir) + "/info/exclude");
+        }
+    }
+
+    for (const auto& file : files) root->rules.loadFile(file);
+    if (root->rules.empty()) return nullptr;
+
+    root->needsPath = root->rules.needsPath();
+    return root;
+}
+
+// Path of a scanned file relative to the folder the scan started from.
+static std::string_view relativeTo(const std::string& folderPath, const std::string_view path) {
+    std::string_view rel = path.substr(std::min(path.size(), folderPath.size()));
+    while (!rel.empty() && rel.front() == '/') rel.remove_prefix(1);
+    return rel;
+}
+
+static void printSkipped(const SkippedFiles& skipped) {
+    if (skipped.total() == 0) return;
+
+    std::string line = "Skipped " + std::to_string(skipped.total()) + " files:";
+    if (skipped.generated) line += " " + std::to_string(skipped.generated) + " generated";
+    if (skipped.minified) line += " " + std::to_string(skipped.minified) + " minified";
+    if (skipped.binary) line += " " + std::to_string(skipped.binary) + " binary";
+    line += " (--all-files to count them)";
+    std::cout << '\n' << colorText(BYellow, centered(line, termWidth())) << '\n';
+}
+
+static void sortStats(std::vector<FileStats>& files) {
+    std::sort(files.begin(), files.end(), [](const FileStats& a, const FileStats& b) {
+        return a.name != b.name ? a.name < b.name : a.lines < b.lines;
+    });
+}
+
+// The menu reuses one CodeCounter, so every run starts from the defaults.
+bool CodeCounter::parseArgs(const std::vector<std::string>& args) {
+    languages = configuredLanguages;
+    threads = defaultThreadCount();
+    useCache = true;
+    useIgnoreFiles = true;
+    useGitIndex = true;
+    useUring = true;
+    allFiles = false;
+    topFiles = 0;
+    dirDepth = 2;
+    watchFolder.clear();
+    snapshotFolder.clear();
+    snapshotFile.clear();
+    diffBefore.clear();
+    diffAfter.clear();
+    ignoreFiles.clear();
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            try {
+                const unsigned long value = std::stoul(args[++i]);
+                if (value == 0) throw std::invalid_argument("zero");
+                threads = value;
+            } catch (const std::exception&) {
+                std::cerr << colorText(BRed, "\n--threads expects a positive number\n");
+                return false;
+            }
+        } else if (args[i] == "--top" && i + 1 < args.size()) {
+            try {
+                const unsigned long value = std::stoul(args[++i]);
+                if (value == 0) throw std::invalid_argument("zero");
+                topFiles = value;
+            } catch (const std::exception&) {
+                std::cerr << colorText(BRed, "\n--top expects a positive number\n");
+                return false;
+            }
+        } else if (args[i] == "--depth" && i + 1 < args.size()) {
+            try {
+                dirDepth = std::stoul(args[++i]);
+            } catch (const std::exception&) {
+                std::cerr << colorText(BRed, "\n--depth expects a number\n");
+                return false;
+            }
+        } else if (args[i] == "--watch" && i + 1 < args.size()) {
+            watchFolder = args[++i];
+        } else if (args[i] == "--snapshot" && i + 2 < args.size()) {
+            snapshotFolder = args[++i];
+            snapshotFile = args[++i];
+        } else if (args[i] == "--diff" && i + 2 < args.size()) {
+            diffBefore = args[++i];
+            diffAfter = args[++i];
+        } else if (args[i] == "--all-files") {
+            allFiles = true;
+        } else if (args[i] == "--no-cache") {
+            useCache = false;
+        } else if (args[i] == "--no-git") {
+            useGitIndex = false;
+        } else if (args[i] == "--no-uring") {
+            useUring = false;
+        } else if (args[i] == "--no-ignore") {
+            useIgnoreFiles = false;
+        } else if (args[i] == "--ignore-file" && i + 1 < args.size()) {
+            ignoreFiles.push_back(args[++i]);
+        } else if (args[i] == "--lang" && i + 1 < args.size()) {
+            if (!languages.addLanguage(args[++i])) {
+                std::cerr << colorText(BRed, "\n--lang expects key=Name:.ext1,.ext2\n");
+                return false;
+            }
+        } else {
+            std::cerr << colorText(BRed, "\nUnknown option: " + args[i] + "\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+struct DirTask {
+    fs::path dir;
+    std::string rel;
+    std::shared_ptr<const IgnoreNode> ignore;
+};
+
+}
+
+// Ignored directories are never enqueued, so nothing below them is listed.
+// .gitignore / .ignore files are picked up from the listing itself and stack
+// on top of the parent directory's rules.
+void CodeCounter::walkTree(const std::string& folderPath, const FileVisitor& onFile) const {
+    WorkStealingPool<DirTask> pool(threads);
+
+    pool.run({DirTask{fs::path(folderPath), "", rootIgnore(folderPath)}}, [&](const size_t worker, DirTask& task) {
+        struct Listed {
+            std::string name;
+            unsigned char type;
+        };
+        thread_local DirReader dir;
+        thread_local std::vector<Listed> entries;
+        thread_local std::string relPath;
+        size_t count = 0;
+
+        bool hasIgnoreFile = false;
+        if (!dir.open(task.dir.c_str())) return;
+        DirReader::Entry entry{};
+        while (dir.next(entry)) {
+            hasIgnoreFile |= entry.name == ".gitignore" || entry.name == ".ignore";
+            if (count == entries.size()) entries.emplace_back();
+            entries[count].name.assign(entry.name);
+            entries[count++].type = entry.type;
+        }
+
+        std::shared_ptr<const IgnoreNode> ignore = task.ignore;
+        if (useIgnoreFiles && hasIgnoreFile) {
+            auto node = std::make_shared<IgnoreNode>();
+            node->rules.loadFile((task.dir / ".gitignore").string());
+            node->rules.loadFile((task.dir / ".ignore").string());
+            if (!node->rules.empty()) {
+                node->parent = task.ignore;
+                node->base = task.rel;
+                node->needsPath = node->rules.needsPath() || (task.ignore && task.ignore->needsPath);
+                ignore = std::move(node);
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const std::string& name = entries[i].name;
+            if (isIgnoredName(name)) continue;
+
+            // d_type answers almost always; a stat relative to the open
+            // directory covers the rest. Symlinks to files are counted,
+            // symlinks to directories are not followed.
+            unsigned char type = entries[i].type;
+            struct stat st{};
+            if (type == DT_UNKNOWN && statAt(dir.fd(), name.c_str(), st)) type = IFTODT(st.st_mode);
+            if (type == DT_LNK) {
+                type = fstatat(dir.fd(), name.c_str(), &st, 0) == 0 && S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+            }
+            const bool isDir = type == DT_DIR;
+
+            if (ignore) {
+                if (ignore->needsPath) {
+                    relPath.assign(task.rel);
+                    if (!relPath.empty()) relPath += '/';
+                    relPath += name;
+                }
+                if (IgnoreNode::isIgnored(ignore.get(), relPath, name, isDir)) continue;
+            }
+
+            if (isDir) {
+                std::string rel = task.rel.empty() ? name : task.rel + '/' + name;
+                pool.push(worker, DirTask{task.dir / name, std::move(rel), ignore});
+            } else if (type == DT_REG) {
+                onFile(worker, task.dir / name);
+            }
+        }
+        dir.close();
+    });
+}
+
+// Tracked files come straight from .git/index and are counted in chunks on
+// the pool; nothing is listed or stat'ed, so build outputs and untracked junk
+// cost nothing. The root rules (--ignore-file, the user ignore file and
+// info/exclude) still apply, to each directory on the path and then to the
+// file. Returns false when the folder is not the top of a work tree.
+bool CodeCounter::walkGitIndex(const std::string& folderPath, const FileVisitor& onFile) const {
+    GitIndex index;
+    if (!index.load(folderPath)) return false;
+    const std::shared_ptr<const IgnoreNode> ignore = rootIgnore(folderPath);
+
+    constexpr size_t chunk = 512;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t begin = 0; begin < index.size(); begin += chunk) {
+        ranges.emplace_back(begin, std::min(index.size(), begin + chunk));
+    }
+
+    WorkStealingPool<std::pair<size_t, size_t>> pool(threads);
+    pool.run(std::move(ranges), [&](const size_t worker, const std::pair<size_t, size_t>& range) {
+        fs::path path;
+        for (size_t i = range.first; i < range.second; ++i) {
+            const std::string_view rel = index.path(i);
+
+            bool ignored = false;
+            for (size_t start = 0; start <= rel.size() && !ignored;) {
+                const size_t slash = std::min(rel.find('/', start), rel.size());
+                const std::string_view name = rel.substr(start, slash - start);
+                ignored = isIgnoredName(name)
+                       || (ignore && IgnoreNode::isIgnored(ignore.get(), rel.substr(0, slash), name, slash < rel.size()));
+                start = slash + 1;
+            }
+            if (ignored) continue;
+
+            path = folderPath;
+            path /= rel;
+            onFile(worker, path);
+        }
+    });
+    return true;
+}
+
+void CodeCounter::scanFiles(const std::string& folderPath, const FileVisitor& onFile, const bool gitIndex) const {
+    if (gitIndex && useGitIndex && walkGitIndex(folderPath, onFile)) return;
+    walkTree(folderPath, onFile);
+}
+
+namespace {
+
+struct Pending {
+    std::vector<std::string> paths;
+    std::vector<LangId> langs;
+    std::vector<struct stat> stats;
+
+    void clear() {
+        paths.clear();
+        langs.clear();
+        stats.clear();
+    }
+};
+
+}
+
+// Cache hits are reported straight from the scan; misses pile up per worker
+// and are read a batch at a time, so the ring always has work in flight.
+// Whatever is left when the scan ends is flushed on the pool as well.
+// Generated, minified and binary files are sniffed from the same buffer and
+// only tallied in `skipped`, unless --all-files asks for them. With
+// hashContent the buffer is hashed too and the hash kept in the cache, so
+// a hit answers it without reading the file.
+std::vector<CacheRecord> CodeCounter::countFiles(const std::string& folderPath, const LangPicker& pick,
+                                                 const LineCache* cache, const StatsVisitor& onStats,
+                                                 SkippedFiles& skipped, const bool hashContent,
+                                                 const bool gitIndex) const {
+    if (TarReader::isArchive(folderPath)) {
+        countArchive(folderPath, pick, onStats, skipped);
+        return {};
+    }
+
+    constexpr size_t batchSize = 256;
+
+    std::vector<Pending> pending(threads);
+    std::vector<std::vector<CacheRecord>> seen(threads);
+    std::vector<SkippedFiles> skippedBy(threads);
+    std::vector<BatchReader> readers;
+    readers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) readers.emplace_back(useUring);
+
+    auto flush = [&](const size_t worker, Pending& batch) {
+        readers[worker].read(batch.paths, [&](const size_t i, const std::string_view content) {
+            const FileKind kind = sniffFile(content);
+            if (kind != FileKind::Source && !allFiles) {
+                skippedBy[worker].add(kind);
+                if (cache) seen[worker].push_back(LineCache::makeRecord(batch.stats[i], {}, batch.langs[i], kind, false));
+                return;
+            }
+
+            const LineStats stats = LineLexer::classify(languages.syntax(batch.langs[i]), content);
+            const std::optional<uint64_t> hash = hashContent ? std::optional(contentHash(content)) : std::nullopt;
+            if (cache) seen[worker].push_back(LineCache::makeRecord(batch.stats[i], stats, batch.langs[i], kind, true, hash));
+            onStats(worker, batch.paths[i], stats, hash.value_or(0));
+        });
+        batch.clear();
+    };
+
+    scanFiles(folderPath, [&](const size_t worker, const fs::path& path) {
+        const LangId lang = pick(path);
+        if (lang == kNoLang) return;
+
+        struct stat st{};
+        if (cache) {
+            if (stat(path.c_str(), &st) != 0) return;
+            const CacheRecord* hit = cache->find(st, lang);
+            if (hit && hit->kind != static_cast<uint8_t>(FileKind::Source) && !allFiles) {
+                seen[worker].push_back(*hit);
+                skippedBy[worker].add(static_cast<FileKind>(hit->kind));
+                return;
+            }
+            // A hit from a run that did not hash is read again, once.
+            if (hit && hit->counted && (hit->hashed || !hashContent)) {
+                seen[worker].push_back(*hit);
+                onStats(worker, path.native(), hit->stats(), hit->hashed ? hit->hash : 0);
+                return;
+            }
+        }
+
+        Pending& batch = pending[worker];
+        batch.paths.push_back(path.native());
+        batch.langs.push_back(lang);
+        batch.stats.push_back(st);
+        if (batch.paths.size() >= batchSize) flush(worker, batch);
+    }, gitIndex);
+
+    std::vector<size_t> leftovers;
+    for (size_t worker = 0; worker < threads; ++worker) {
+        if (!pending[worker].paths.empty()) leftovers.push_back(worker);
+    }
+    WorkStealingPool<size_t> pool(threads);
+    pool.run(std::move(leftovers), [&](const size_t worker, const size_t owner) {
+        flush(worker, pending[owner]);
+    });
+
+    for (const auto& part : skippedBy) skipped += part;
+
+    std::vector<CacheRecord> records;
+    for (auto& part : seen) std::ranges::move(part, std::back_inserter(records));
+    return records;
+}
+
+// Members are counted straight out of the decompression buffer on the calling
+// thread (a gzip stream cannot be split anyway). They are reported as
+// "<archive>/<member path>" so the reports treat the archive as a folder.
+void CodeCounter::countArchive(const std::string& archivePath, const LangPicker& pick,
+                               const StatsVisitor& onStats, SkippedFiles& skipped) const {
+    TarReader tar;
+    if (!tar.open(archivePath)) {
+        std::cerr << colorText(BRed, "\n" + tar.error() + "\n");
+        return;
+    }
+
+    TarReader::Member member;
+    std::string path;
+    std::string head;
+    constexpr size_t sniffBytes = 4096;
+
+    while (tar.next(member)) {
+        if (isIgnorePath(fs::path(member.path))) continue;
+        path = archivePath + '/' + member.path;
+        const LangId lang = pick(fs::path(path));
+        if (lang == kNoLang) continue;
+
+        // The classifier wants the first few KB in one piece; only a member
+        // that straddles a buffer refill needs them copied.
+        std::string_view chunk = tar.read();
+        std::string_view first = chunk;
+        const size_t wanted = static_cast<size_t>(std::min<uint64_t>(member.size, sniffBytes));
+        if (chunk.size() < wanted) {
+            head.assign(chunk);
+            while (head.size() < wanted && !(chunk = tar.read()).empty()) head.append(chunk);
+            first = head;
+        }
+
+        const FileKind kind = sniffFile(first);
+        if (kind != FileKind::Source && !allFiles) {
+            skipped.add(kind);
+            continue;
+        }
+
+        LineLexer lexer(languages.syntax(lang));
+        lexer.feed(first);
+        while (!(chunk = tar.read()).empty()) lexer.feed(chunk);
+        onStats(0, path, lexer.finish(), 0);
+    }
+
+    if (!tar.error().empty()) {
+        std::cerr << colorText(BRed, "\n" + archivePath + ": " + tar.error() + "\n");
+    }
+}
+
+void CodeCounter::execute(const std::vector<std::string>& args) {
+    if (!parseArgs(args)) return;
+
+    if (!watchFolder.empty()) {
+        if (!fs::is_directory(watchFolder)) {
+            std::cerr << colorText(BRed, "\nInvalid Path: " + watchFolder + "\n");
+            return;
+        }
+        watchTree(watchFolder);
+        return;
+    }
+    if (!snapshotFile.empty()) {
+        saveSnapshot(snapshotFolder, snapshotFile);
+        return;
+    }
+    if (!diffBefore.empty()) {
+        diffTrees(diffBefore, diffAfter);
+        return;
+    }
+
     clearScreen();
     for (size_t i = 0; i < 9; ++i) std::cout << '\n';
 
@@ -83,12 +512,32 @@ void CodeCounter::execute([[maybe_unused]] const std::vector<std::string>& args)
         "",
         "Commands:",
         "  1  - Show project (only C++) line count",
-        "  2  - Show project Language line count",
+        "  2  - Show project Language line count (code / comment / blank)",
+        "  3  - Show line count per directory, largest first",
         "",
         "Supported Languages:",
         "  C++, C#, Java, Python, Go, Rust, PHP, Assembly,",
         "  JavaScript, TypeScript, Swift, Kotlin, Ruby",
         "",
+        "A .tar / .tar.gz / .tgz file can be given instead of a folder.",
+        "",
+        "Options:",
+        "  --threads N - scan with N worker threads (default: all cores)",
+        "  --top N     - keep only the N largest files per table / language",
+        "  --depth N   - directory levels shown by command 3 (default: 2)",
+        "  --watch DIR - keep language totals of DIR live (Linux)",
+        "  --snapshot DIR FILE - save per-file counts of DIR to FILE",
+        "  --diff A B  - lines added / removed from A to B, each a",
+        "                snapshot FILE or a folder scanned now",
+        "  --all-files - also count generated, minified and binary files",
+        "  --no-cache  - recount every file, ignore the line-count cache",
+        "  --no-git    - walk the folder even if it has a .git/index",
+        "  --no-ignore - do not read .gitignore / .ignore files",
+        "  --no-uring  - read files one by one instead of via io_uring",
+        "  --ignore-file PATH - extra gitignore-style patterns",
+        "  --lang key=Name:.ext1,.ext2 - add a language (also read from",
+        "                ~/.config/cliutils/languages, one per line)",
+        "",
         "Navigation:",
         "  q, quit - go back to main menu"
     };
@@ -105,6 +554,7 @@ void CodeCounter::execute([[maybe_unused]] const std::vector<std::string>& args)
             switch (std::stoi(input)) {
                 case 1: getFolderStats(); break;
                 case 2: getLangStats(); break;
+                case 3: getDirStats(); break;
                 default: std::cout << '\n' << colorText(BRed, centered("Wrong input!\n", termWidth())); continue;
             }
         } catch (const std::invalid_argument&) {
@@ -117,58 +567,576 @@ void CodeCounter::getFolderStats() const {
     const std::string folderPath = inputFolder();
     if (folderPath.empty()) return;
 
+    struct Partial {
+        std::vector<FileStats> headers;
+        std::vector<FileStats> sources;
+        TopFiles topHeaders;
+        TopFiles topSources;
+        size_t totalHeadersLine = 0;
+        size_t totalSourcesLine = 0;
+    };
+    std::vector<Partial> partials(threads);
+    for (auto& part : partials) {
+        part.topHeaders = TopFiles(topFiles);
+        part.topSources = TopFiles(topFiles);
+    }
+
+    const std::unique_ptr<LineCache> cache = openCache(folderPath);
+    const LangId cppLang = languages.findKey("cpp");
+
+    auto isHeader = [](const std::string_view extension) {
+        return extension == ".h" || extension == ".hpp" || extension == ".tpp";
+    };
+    auto isSource = [](const std::string_view extension) {
+        return extension == ".cpp" || extension == ".cc" || extension == ".cxx";
+    };
+
+    auto pick = [&](const fs::path& path) {
+        const std::string_view extension = extensionOf(path.native());
+        return isHeader(extension) || isSource(extension) ? cppLang : kNoLang;
+    };
+    SkippedFiles skipped;
+    std::vector<CacheRecord> seen = countFiles(folderPath, pick, cache.get(),
+        [&](const size_t worker, const std::string_view path, const LineStats& stats, uint64_t) {
+            Partial& part = partials[worker];
+            const std::string_view name = path.substr(path.rfind('/') + 1);
+
+            if (isHeader(extensionOf(path))) {
+                if (topFiles) part.topHeaders.offer(name, stats.lines);
+                else part.headers.push_back({std::string(name), stats.lines});
+                part.totalHeadersLine += stats.lines;
+            } else {
+                if (topFiles) part.topSources.offer(name, stats.lines);
+                else part.sources.push_back({std::string(name), stats.lines});
+                part.totalSourcesLine += stats.lines;
+            }
+        }, skipped);
+
     std::vector<FileStats> headers;
     std::vector<FileStats> sources;
 
     size_t totalHeadersLine = 0;
     size_t totalSourcesLine = 0;
+    TopFiles topHeaders(topFiles);
+    TopFiles topSources(topFiles);
+
+    for (auto& part : partials) {
+        std::ranges::move(part.headers, std::back_inserter(headers));
+        std::ranges::move(part.sources, std::back_inserter(sources));
+        topHeaders.merge(std::move(part.topHeaders));
+        topSources.merge(std::move(part.topSources));
+        totalHeadersLine += part.totalHeadersLine;
+        totalSourcesLine += part.totalSourcesLine;
+    }
+    if (cache) cache->save(std::move(seen), true);
+
+    if (topFiles) {
+        headers = topHeaders.take();
+        sources = topSources.take();
+    } else {
+        sortStats(headers);
+        sortStats(sources);
+    }
+
+    std::cout << '\n';
+    printTable(headers, sources, totalHeadersLine, totalSourcesLine);
+    printSkipped(skipped);
+}
+
+CodeCounter::LangReport CodeCounter::langReport(const std::string& folderPath) const {
+    struct Partial {
+        std::vector<std::vector<FileStats>> filesByLang;
+        std::vector<TopFiles> topByLang;
+        std::vector<LineStats> totalsByLang;
+    };
+    std::vector<Partial> partials(threads);
+    for (auto& part : partials) {
+        part.filesByLang.resize(languages.size());
+        part.topByLang.resize(languages.size(), TopFiles(topFiles));
+        part.totalsByLang.resize(languages.size());
+    }
+
+    const std::unique_ptr<LineCache> cache = openCache(folderPath);
 
-    for (auto& entry : fs::recursive_directory_iterator(folderPath)) {
-        if (!entry.is_regular_file() || isIgnorePath(entry.path())) continue;
+    auto pick = [&](const fs::path& path) { return languages.find(extensionOf(path.native())); };
+    LangReport report;
+    std::vector<CacheRecord> seen = countFiles(folderPath, pick, cache.get(),
+        [&](const size_t worker, const std::string_view path, const LineStats& stats, uint64_t) {
+            const LangId lang = languages.find(extensionOf(path));
+            const std::string_view name = path.substr(path.rfind('/') + 1);
+            Partial& part = partials[worker];
+            if (topFiles) part.topByLang[lang].offer(name, stats.lines);
+            else part.filesByLang[lang].push_back({std::string(name), stats.lines});
+            part.totalsByLang[lang] += stats;
+        }, report.skipped);
 
-        auto path = entry.path();
-        auto extension = path.extension().string();
+    report.filesByLang.resize(languages.size());
+    report.counts.resize(languages.size());
+    report.totalsByLang.resize(languages.size());
+    std::vector<TopFiles> topByLang(languages.size(), TopFiles(topFiles));
 
-        if (extension == ".h" || extension == ".hpp" || extension == ".tpp") {
-            const size_t lines = countLine(path);
-            headers.push_back({path.filename().string(), lines});
-            totalHeadersLine += lines;
+    for (auto& part : partials) {
+        for (size_t lang = 0; lang < languages.size(); ++lang) {
+            std::ranges::move(part.filesByLang[lang], std::back_inserter(report.filesByLang[lang]));
+            topByLang[lang].merge(std::move(part.topByLang[lang]));
+            report.totalsByLang[lang] += part.totalsByLang[lang];
         }
+    }
+    if (cache) cache->save(std::move(seen), false);
 
-        if (extension == ".cpp" || extension == ".cc" || extension == ".cxx") {
-            const size_t lines = countLine(path);
-            sources.push_back({path.filename().string(), lines});
-            totalSourcesLine += lines;
+    for (size_t lang = 0; lang < languages.size(); ++lang) {
+        if (topFiles) {
+            report.counts[lang] = topByLang[lang].count();
+            report.filesByLang[lang] = topByLang[lang].take();
+        } else {
+            report.counts[lang] = report.filesByLang[lang].size();
+            sortStats(report.filesByLang[lang]);
         }
     }
+    return report;
+}
+
+void CodeCounter::getLangStats() {
+    const std::string folderPath = inputFolder();
+    if (folderPath.empty()) return;
+
+    const LangReport report = langReport(folderPath);
 
     std::cout << '\n';
-    printTable(headers, sources, totalHeadersLine, totalSourcesLine);
+    if (topFiles) printTopByLanguage(report.filesByLang, report.counts, report.totalsByLang, languages.all());
+    else printByLanguage(report.filesByLang, report.totalsByLang, languages.all());
+    printSkipped(report.skipped);
 }
 
-void CodeCounter::getLangStats() {
-    initMap();
+// Same single scan as getLangStats; each file's lines land on its directory
+// node and DirTree::rollUp carries them to every ancestor afterwards.
+void CodeCounter::getDirStats() const {
     const std::string folderPath = inputFolder();
     if (folderPath.empty()) return;
 
-    std::map<std::string, std::vector<FileStats>> filesByLang;
-    std::map<std::string, size_t> totalsByLang;
+    DirTree tree(languages.size());
+
+    struct Partial {
+        std::string dir;
+        uint32_t node = DirTree::kRoot;
+        size_t files = 0;
+        std::vector<size_t> lines;
+    };
+    std::vector<Partial> partials(threads);
+    for (auto& part : partials) part.lines.resize(languages.size());
+
+    auto flush = [&](Partial& part) {
+        if (part.files == 0) return;
+        tree.add(part.node, part.files, part.lines);
+        part.files = 0;
+        std::ranges::fill(part.lines, 0);
+    };
 
-    for (auto& entry : fs::recursive_directory_iterator(folderPath)) {
-        if (!entry.is_regular_file() || isIgnorePath(entry.path())) continue;
+    const std::unique_ptr<LineCache> cache = openCache(folderPath);
 
-        auto path = entry.path();
-        auto extension = path.extension().string();
+    auto pick = [&](const fs::path& path) { return languages.find(extensionOf(path.native())); };
+    SkippedFiles skipped;
+    std::vector<CacheRecord> seen = countFiles(folderPath, pick, cache.get(),
+        [&](const size_t worker, const std::string_view path, const LineStats& stats, uint64_t) {
+            const std::string_view rel = relativeTo(folderPath, path);
+            const size_t slash = rel.rfind('/');
+            const std::string_view dir = slash == std::string_view::npos ? std::string_view() : rel.substr(0, slash);
 
-        for (const auto& [langKey, config] : languageMap) {
-            if (std::find(config.extension.begin(), config.extension.end(), extension) != config.extension.end()) {
-                const size_t lines = countLine(path);
-                filesByLang[langKey].push_back({path.filename().string(), lines});
-                totalsByLang[langKey] += lines;
+            Partial& part = partials[worker];
+            if (dir != part.dir || part.files == 0) {
+                flush(part);
+                part.dir.assign(dir);
+                part.node = tree.intern(dir);
             }
+            part.lines[languages.find(extensionOf(path))] += stats.lines;
+            ++part.files;
+        }, skipped);
+
+    for (auto& part : partials) flush(part);
+    if (cache) cache->save(std::move(seen), false);
+    tree.rollUp();
+
+    std::vector<std::vector<uint32_t>> children = tree.children();
+    for (auto& list : children) {
+        std::ranges::sort(list, [&](const uint32_t a, const uint32_t b) {
+            const size_t ta = tree.total(a), tb = tree.total(b);
+            return ta != tb ? ta > tb : tree[a].name < tree[b].name;
+        });
+    }
+
+    auto languageMix = [&](const uint32_t id) {
+        const size_t* lines = tree.counters(id);
+        std::vector<LangId> present;
+        for (LangId lang = 0; lang < languages.size(); ++lang) {
+            if (lines[lang] > 0) present.push_back(lang);
         }
+        std::ranges::sort(present, [&](const LangId a, const LangId b) { return lines[a] > lines[b]; });
+
+        std::string mix;
+        for (size_t i = 0; i < present.size() && i < 3; ++i) {
+            if (!mix.empty()) mix += ", ";
+            mix += languages[present[i]].name + " " + std::to_string(lines[present[i]]);
+        }
+        if (present.size() > 3) mix += ", +" + std::to_string(present.size() - 3);
+        return mix;
+    };
+
+    std::vector<std::vector<std::string>> rows;
+    rows.push_back({"Directory", "Files", "Lines", "Languages"});
+
+    std::vector<uint32_t> stack = {DirTree::kRoot};
+    while (!stack.empty()) {
+        const uint32_t id = stack.back();
+        stack.pop_back();
+        if (tree.total(id) == 0) continue;
+
+        const auto& node = tree[id];
+        const std::string name = id == DirTree::kRoot ? shortPath(folderPath) : node.name + "/";
+        rows.push_back({
+            std::string(2 * node.depth, ' ') + name,
+            std::to_string(node.files),
+            std::to_string(tree.total(id)),
+            languageMix(id)
+        });
+
+        if (node.depth >= dirDepth) continue;
+        for (auto it = children[id].rbegin(); it != children[id].rend(); ++it) stack.push_back(*it);
     }
 
     std::cout << '\n';
-    printByLanguage(filesByLang, totalsByLang, languageMap);
+    printProcessTable(rows);
+    printSkipped(skipped);
+}
+
+// `codecounter --watch DIR`: one full scan, then only the files inotify
+// reports are read again; their previous counts are swapped out of the
+// totals. The scan walks the folder instead of reading the git index, so
+// untracked files count from the start, as they do once an event names
+// them; ignore rules are the same for both, looked up per event.
+void CodeCounter::watchTree(const std::string& folderPath) const {
+    const std::shared_ptr<const IgnoreNode> rootRules = rootIgnore(folderPath);
+    std::unordered_map<std::string, std::shared_ptr<const IgnoreNode>> ignoreByDir;
+
+    std::function<std::shared_ptr<const IgnoreNode>(const std::string&)> ignoreFor =
+        [&](const std::string& relDir) -> std::shared_ptr<const IgnoreNode> {
+            if (const auto it = ignoreByDir.find(relDir); it != ignoreByDir.end()) return it->second;
+
+            std::shared_ptr<const IgnoreNode> node = rootRules;
+            if (!relDir.empty()) {
+                const size_t slash = relDir.rfind('/');
+                node = ignoreFor(slash == std::string::npos ? "" : relDir.substr(0, slash));
+            }
+            if (useIgnoreFiles) {
+                const std::string dir = relDir.empty() ? folderPath : folderPath + '/' + relDir;
+                auto own = std::make_shared<IgnoreNode>();
+                own->rules.loadFile(dir + "/.gitignore");
+                own->rules.loadFile(dir + "/.ignore");
+                if (!own->rules.empty()) {
+                    own->needsPath = own->rules.needsPath() || (node && node->needsPath);
+                    own->parent = std::move(node);
+                    own->base = relDir;
+                    node = std::move(own);
+                }
+            }
+            return ignoreByDir.emplace(relDir, std::move(node)).first->second;
+        };
+
+    auto ignored = [&](const std::string_view relPath, const bool isDir) {
+        for (size_t start = 0; start < relPath.size();) {
+            const size_t slash = std::min(relPath.find('/', start), relPath.size());
+            const std::string_view name = relPath.substr(start, slash - start);
+            if (isIgnoredName(name)) return true;
+
+            const auto node = ignoreFor(std::string(relPath.substr(0, start == 0 ? 0 : start - 1)));
+            if (node && IgnoreNode::isIgnored(node.get(), relPath.substr(0, slash), name,
+                                              slash < relPath.size() || isDir)) return true;
+            start = slash + 1;
+        }
+        return false;
+    };
+
+    struct Counted {
+        LangId lang;
+        LineStats stats;
+    };
+    std::unordered_map<std::string, Counted> files;
+    std::vector<LineStats> totals(languages.size());
+    std::vector<size_t> counts(languages.size());
+
+    auto remember = [&](std::string rel, const LangId lang, const LineStats& stats) {
+        totals[lang] += stats;
+        ++counts[lang];
+        files.insert_or_assign(std::move(rel), Counted{lang, stats});
+    };
+
+    auto fullScan = [&] {
+        files.clear();
+        std::ranges::fill(totals, LineStats{});
+        std::ranges::fill(counts, 0);
+
+        const std::unique_ptr<LineCache> cache = openCache(folderPath);
+
+        std::vector<std::vector<std::pair<std::string, LineStats>>> found(threads);
+        auto pick = [&](const fs::path& path) { return languages.find(extensionOf(path.native())); };
+        SkippedFiles skipped;
+        std::vector<CacheRecord> seen = countFiles(folderPath, pick, cache.get(),
+            [&](const size_t worker, const std::string_view path, const LineStats& stats, uint64_t) {
+                found[worker].emplace_back(relativeTo(folderPath, path), stats);
+            }, skipped, false, false);
+        if (cache) cache->save(std::move(seen), false);
+
+        for (auto& part : found) {
+            for (auto& [rel, stats] : part) {
+                const LangId lang = languages.find(extensionOf(rel));
+                remember(std::move(rel), lang, stats);
+            }
+        }
+    };
+
+    BatchReader reader(useUring);
+
+    // Every path is forgotten first and counted again only if it still
+    // exists, so created, written, moved and deleted files all take one path.
+    auto apply = [&](const TreeWatcher::Changes& changes) {
+        std::unordered_set<std::string> queued;
+        std::vector<std::string> paths;
+        std::vector<std::string> rels;
+        std::vector<LangId> langs;
+
+        auto queue = [&](std::string rel) {
+            if (!queued.insert(rel).second) return;
+            if (const auto it = files.find(rel); it != files.end()) {
+                totals[it->second.lang] -= it->second.stats;
+                --counts[it->second.lang];
+                files.erase(it);
+            }
+
+            const LangId lang = languages.find(extensionOf(rel));
+            if (lang == kNoLang || ignored(rel, false)) return;
+            paths.push_back(folderPath + '/' + rel);
+            rels.push_back(std::move(rel));
+            langs.push_back(lang);
+        };
+
+        for (const auto& dir : changes.dirs) {
+            const std::string prefix = dir + '/';
+            std::vector<std::string> known;
+            for (const auto& [rel, counted] : files) {
+                if (rel.starts_with(prefix)) known.push_back(rel);
+            }
+            for (auto& rel : known) queue(std::move(rel));
+
+            std::error_code ec;
+            fs::recursive_directory_iterator it(folderPath + '/' + dir, fs::directory_options::skip_permission_denied, ec);
+            for (const fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+                std::string rel = prefix + it->path().native().substr(folderPath.size() + prefix.size() + 1);
+                std::error_code typeEc;
+                if (it->is_directory(typeEc)) {
+                    if (ignored(rel, true)) it.disable_recursion_pending();
+                } else if (it->is_regular_file(typeEc)) {
+                    queue(std::move(rel));
+                }
+            }
+        }
+        for (const auto& rel : changes.files) queue(rel);
+
+        reader.read(paths, [&](const size_t i, const std::string_view content) {
+            if (!allFiles && sniffFile(content) != FileKind::Source) return;
+            remember(rels[i], langs[i], LineLexer::classify(languages.syntax(langs[i]), content));
+        });
+        return queued.size();
+    };
+
+    auto render = [&](const std::string& status) {
+        clearScreen();
+        for (size_t i = 0; i < 5; ++i) std::cout << '\n';
+        std::cout << colorText(BWhite, centered("Watching " + shortPath(folderPath) + " (press 'q' to exit)",
+                                                termWidth())) << "\n\n";
+
+        std::vector<std::vector<std::string>> rows;
+        rows.push_back({"Language", "Files", "Code", "Comments", "Blank", "Lines"});
+        LineStats all;
+        size_t shownFiles = 0;
+        for (LangId lang = 0; lang < languages.size(); ++lang) {
+            if (counts[lang] == 0) continue;
+            const LineStats& t = totals[lang];
+            rows.push_back({languages[lang].name, std::to_string(counts[lang]), std::to_string(t.code),
+                            std::to_string(t.comment), std::to_string(t.blank), std::to_string(t.lines)});
+            all += t;
+            shownFiles += counts[lang];
+        }
+        rows.push_back({"Total", std::to_string(shownFiles), std::to_string(all.code),
+                        std::to_string(all.comment), std::to_string(all.blank), std::to_string(all.lines)});
+        printProcessTable(rows);
+
+        std::cout << '\n' << colorText(BWhite, centered(status, termWidth())) << '\n';
+        std::cout.flush();
+    };
+
+    auto now = [] {
+        const std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::ostringstream ss;
+        ss << std::put_time(std::localtime(&time), "%H:%M:%S");
+        return ss.str();
+    };
+
+    // Watches go up before the scan, so nothing written meanwhile is missed.
+    TreeWatcher watcher;
+    if (!watcher.start(folderPath, [&](const std::string_view rel) { return ignored(rel, true); })) {
+        std::cerr << colorText(BRed, "\nCannot watch " + folderPath + ": inotify is not available\n");
+        return;
+    }
+    fullScan();
+
+    std::string status = now() + " - scanned " + std::to_string(files.size()) + " files";
+    if (watcher.failed() > 0) {
+        status += ", " + std::to_string(watcher.failed()) + " folders unwatched (raise fs.inotify.max_user_watches)";
+    }
+    render(status);
+
+    while (getCharNonBlocking() != 'q') {
+        const TreeWatcher::Changes changes = watcher.poll(500, 200);
+        if (changes.empty()) continue;
+
+        if (changes.overflow) {
+            fullScan();
+            render(now() + " - events were dropped, rescanned " + std::to_string(files.size()) + " files");
+        } else {
+            render(now() + " - " + std::to_string(apply(changes)) + " changed paths recounted");
+        }
+    }
+}
+
+std::vector<std::string> CodeCounter::languageNames() const {
+    std::vector<std::string> names;
+    names.reserve(languages.size());
+    for (const auto& lang : languages.all()) names.push_back(lang.name);
+    return names;
+}
+
+// Content hashes come from the buffer the count already read, or from the
+// cache for unchanged files, so no file is read twice. Archive members are
+// lexed as they stream by and keep a zero hash: they compare by line count
+// alone.
+std::vector<SnapshotEntry> CodeCounter::snapshotEntries(const std::string& folderPath) const {
+    std::vector<std::vector<SnapshotEntry>> partials(threads);
+    const std::unique_ptr<LineCache> cache = openCache(folderPath);
+
+    auto pick = [&](const fs::path& path) { return languages.find(extensionOf(path.native())); };
+    SkippedFiles skipped;
+    std::vector<CacheRecord> seen = countFiles(folderPath, pick, cache.get(),
+        [&](const size_t worker, const std::string_view path, const LineStats& stats, const uint64_t hash) {
+            partials[worker].push_back({std::string(relativeTo(folderPath, path)), languages.find(extensionOf(path)), stats, hash});
+        }, skipped, true);
+    if (cache) cache->save(std::move(seen), false);
+
+    std::vector<SnapshotEntry> entries;
+    for (auto& part : partials) std::ranges::move(part, std::back_inserter(entries));
+    std::ranges::stable_sort(entries, {}, &SnapshotEntry::path);
+
+    // An archive appended to with `tar -r` can hold a member more than once,
+    // in archive order on worker 0; the last copy is what extracting gives.
+    const auto kept = std::unique(entries.rbegin(), entries.rend(), [](const SnapshotEntry& a, const SnapshotEntry& b) {
+        return a.path == b.path;
+    });
+    entries.erase(entries.begin(), kept.base());
+    return entries;
+}
+
+void CodeCounter::saveSnapshot(const std::string& folderPath, const std::string& file) const {
+    const bool archive = TarReader::isArchive(folderPath) && fs::is_regular_file(folderPath);
+    if (!archive && !fs::is_directory(folderPath)) {
+        std::cerr << colorText(BRed, "\nInvalid Path: " + folderPath + "\n");
+        return;
+    }
+
+    const std::vector<SnapshotEntry> entries = snapshotEntries(folderPath);
+
+    SnapshotWriter writer;
+    bool ok = writer.open(file, languageNames());
+    for (size_t i = 0; ok && i < entries.size(); ++i) ok = writer.add(entries[i]);
+    if (!ok || !writer.finish()) {
+        std::cerr << colorText(BRed, "\n" + writer.error() + "\n");
+        return;
+    }
+    std::cout << colorText(BGreen, "Saved " + std::to_string(entries.size()) + " files to " + file) << '\n';
+}
+
+// Each side is either a snapshot, streamed straight from disk, or a folder
+// (or archive) scanned now and sorted in memory. Either way the diff itself
+// is a single merge of two path-ordered streams.
+void CodeCounter::diffTrees(const std::string& before, const std::string& after) const {
+    SnapshotReader readers[2];
+    std::vector<SnapshotEntry> live[2];
+    std::vector<std::string> names[2];
+    EntrySource sources[2];
+
+    const std::string* paths[2] = {&before, &after};
+    for (size_t side = 0; side < 2; ++side) {
+        const std::string& path = *paths[side];
+        if (SnapshotReader::isSnapshot(path)) {
+            if (!readers[side].open(path)) {
+                std::cerr << colorText(BRed, "\n" + readers[side].error() + "\n");
+                return;
+            }
+            names[side] = readers[side].languages();
+            sources[side] = [&reader = readers[side]](SnapshotEntry& entry) { return reader.next(entry); };
+        } else if (fs::is_directory(path) || (TarReader::isArchive(path) && fs::is_regular_file(path))) {
+            live[side] = snapshotEntries(path);
+            names[side] = languageNames();
+            sources[side] = [&entries = live[side], next = size_t{0}](SnapshotEntry& entry) mutable {
+                if (next == entries.size()) return false;
+                entry = std::move(entries[next++]);
+                return true;
+            };
+        } else {
+            std::cerr << colorText(BRed, "\nNot a snapshot or folder: " + path + "\n");
+            return;
+        }
+    }
+
+    const SnapshotDiff diff = diffSnapshots(sources[0], names[0], sources[1], names[1], dirDepth);
+    for (const auto& reader : readers) {
+        if (!reader.error().empty()) {
+            std::cerr << colorText(BRed, "\n" + reader.error() + ", the diff is incomplete\n");
+        }
+    }
+
+    auto net = [](const LineDelta& d) {
+        return d.linesAdded >= d.linesRemoved ? "+" + std::to_string(d.linesAdded - d.linesRemoved)
+                                              : "-" + std::to_string(d.linesRemoved - d.linesAdded);
+    };
+    auto printDeltas = [&](const std::string& title, std::vector<std::pair<std::string, LineDelta>> deltas) {
+        std::erase_if(deltas, [](const auto& entry) { return entry.second.empty(); });
+        if (deltas.empty()) return;
+        std::ranges::sort(deltas, [](const auto& a, const auto& b) {
+            return a.second.churn() != b.second.churn() ? a.second.churn() > b.second.churn() : a.first < b.first;
+        });
+
+        std::vector<std::vector<std::string>> rows;
+        rows.push_back({title, "Added", "Removed", "Changed", "Lines +", "Lines -", "Net"});
+        for (const auto& [name, d] : deltas) {
+            rows.push_back({
+                name,
+                std::to_string(d.filesAdded),
+                std::to_string(d.filesRemoved),
+                std::to_string(d.filesChanged),
+                "+" + std::to_string(d.linesAdded),
+                "-" + std::to_string(d.linesRemoved),
+                net(d)
+            });
+        }
+        std::cout << '\n';
+        printProcessTable(rows);
+    };
+
+    printDeltas("Language", {diff.byLang.begin(), diff.byLang.end()});
+    printDeltas("Directory", {diff.byDir.begin(), diff.byDir.end()});
+
+    const LineDelta& total = diff.total;
+    const std::string summary = std::to_string(total.filesAdded) + " added, "
+        + std::to_string(total.filesRemoved) + " removed, " + std::to_string(total.filesChanged) + " changed, "
+        + std::to_string(diff.unchanged) + " unchanged files; lines +" + std::to_string(total.linesAdded)
+        + " -" + std::to_string(total.linesRemoved) + " (" + net(total) + ")";
+    std::cout << '\n' << colorText(BWhite, centered(summary, termWidth())) << '\n';
 }
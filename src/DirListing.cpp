@@ -0,0 +1,68 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "DirListing.h"
+#include "DirReader.h"
+#include <algorithm>
+#include <fcntl.h>
+
+bool DirListing::read(const std::string& folder) {
+    entries.clear();
+    names.clear();
+    total = 0;
+    current = Order::Name;
+
+    DirReader dir;
+    if (!dir.open(folder.c_str())) return false;
+
+    DirReader::Entry entry{};
+    struct stat st{};
+    while (dir.next(entry)) {
+        ListedEntry listed;
+        listed.nameOffset = static_cast<uint32_t>(names.size());
+        listed.nameSize = static_cast<uint16_t>(entry.name.size());
+        names.append(entry.name);
+
+        if (fstatat(dir.fd(), entry.name.data(), &st, 0) == 0) {
+            listed.size = static_cast<uint64_t>(st.st_size);
+            listed.mtime = static_cast<int64_t>(st.st_mtime);
+            switch (st.st_mode & S_IFMT) {
+                case S_IFDIR: listed.kind = ListedEntry::Kind::Dir; break;
+                case S_IFREG: listed.kind = ListedEntry::Kind::File; break;
+                default:      listed.kind = ListedEntry::Kind::Other; break;
+            }
+            total += listed.size;
+        }
+        entries.push_back(listed);
+    }
+
+    sort(Order::Name);
+    return true;
+}
+
+void DirListing::sort(const Order by) {
+    current = by;
+    auto byName = [this](const ListedEntry& a, const ListedEntry& b) { return nameOf(a) < nameOf(b); };
+
+    switch (by) {
+        case Order::Name:
+            std::sort(entries.begin(), entries.end(), byName);
+            break;
+        case Order::Size:
+            std::sort(entries.begin(), entries.end(), [&byName](const ListedEntry& a, const ListedEntry& b) {
+                return a.size != b.size ? a.size > b.size : byName(a, b);
+            });
+            break;
+        case Order::Age:
+            std::sort(entries.begin(), entries.end(), [&byName](const ListedEntry& a, const ListedEntry& b) {
+                return a.mtime != b.mtime ? a.mtime < b.mtime : byName(a, b);
+            });
+            break;
+    }
+}
+
+void DirListing::erase(const size_t i) {
+    if (entries[i].kind != ListedEntry::Kind::Unreadable) total -= entries[i].size;
+    entries.erase(entries.begin() + static_cast<ptrdiff_t>(i));
+}
@@ -0,0 +1,169 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "DirReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+#include <sys/resource.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+constexpr int kOpenFlags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+
+#if defined(__linux__)
+constexpr size_t kBufferSize = 64 * 1024;
+
+// Layout the kernel writes; glibc only exposes getdents64() since 2.30.
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+#endif
+
+bool isDots(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+}
+
+DirReader::~DirReader() {
+    close();
+}
+
+DirReader::DirReader(DirReader&& other) noexcept {
+    *this = std::move(other);
+}
+
+DirReader& DirReader::operator=(DirReader&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    dirFd = std::exchange(other.dirFd, -1);
+    readError = other.readError;
+#if defined(__linux__)
+    buffer = std::move(other.buffer);
+    begin = std::exchange(other.begin, 0);
+    end = std::exchange(other.end, 0);
+#else
+    dir = std::exchange(other.dir, nullptr);
+#endif
+    return *this;
+}
+
+void DirReader::close() {
+#if defined(__linux__)
+    if (dirFd >= 0) ::close(dirFd);
+    begin = end = 0;
+#else
+    if (dir) closedir(dir);
+    dir = nullptr;
+#endif
+    dirFd = -1;
+}
+
+bool DirReader::attach(const int fd) {
+    readError = false;
+    if (fd < 0) return false;
+#if defined(__linux__)
+    if (!buffer) buffer = std::make_unique<char[]>(kBufferSize);
+    dirFd = fd;
+#else
+    // fdopendir owns the fd from here on; closedir closes it.
+    dir = fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        return false;
+    }
+    dirFd = fd;
+#endif
+    return true;
+}
+
+bool DirReader::open(const char* path) {
+    close();
+    return attach(::open(path, kOpenFlags));
+}
+
+bool DirReader::adopt(const int fd) {
+    close();
+    return attach(fd);
+}
+
+bool DirReader::openAt(const int parentFd, const char* name) {
+    close();
+    return attach(::openat(parentFd, name, kOpenFlags | O_NOFOLLOW));
+}
+
+#if defined(__linux__)
+
+bool DirReader::next(Entry& entry) {
+    if (dirFd < 0) return false;
+    while (true) {
+        if (begin >= end) {
+            const long n = syscall(SYS_getdents64, dirFd, buffer.get(), kBufferSize);
+            if (n <= 0) {
+                readError = n < 0;
+                return false;
+            }
+            begin = 0;
+            end = static_cast<size_t>(n);
+        }
+
+        const auto* d = reinterpret_cast<const LinuxDirent64*>(buffer.get() + begin);
+        begin += d->d_reclen;
+        if (isDots(d->d_name)) continue;
+
+        entry.name = std::string_view(d->d_name);
+        entry.type = d->d_type;
+        return true;
+    }
+}
+
+#else
+
+bool DirReader::next(Entry& entry) {
+    if (!dir) return false;
+    while (true) {
+        errno = 0;
+        const dirent* d = readdir(dir);
+        if (!d) {
+            readError = errno != 0;
+            return false;
+        }
+        if (isDots(d->d_name)) continue;
+
+        entry.name = std::string_view(d->d_name);
+        entry.type = d->d_type;
+        return true;
+    }
+}
+
+#endif
+
+bool statAt(const int dirFd, const char* name, struct stat& st) {
+    return fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+unsigned char entryType(const int dirFd, const DirReader::Entry& entry) {
+    if (entry.type != DT_UNKNOWN) return entry.type;
+    struct stat st{};
+    if (!statAt(dirFd, entry.name.data(), st)) return DT_UNKNOWN;
+    return IFTODT(st.st_mode);
+}
+
+size_t descriptorBudget() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) return 256;
+    return std::clamp<size_t>(limit.rlim_cur / 4, 16, 1024);
+}
@@ -0,0 +1,74 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "DirTree.h"
+
+DirTree::DirTree(const size_t width) : width(width) {
+    nodes.push_back({kRoot, 0, ""});
+    sums.resize(width);
+    ids.emplace("", kRoot);
+}
+
+uint32_t DirTree::intern(const std::string_view relDir) {
+    std::lock_guard lock(mutex);
+    if (const auto it = ids.find(std::string(relDir)); it != ids.end()) return it->second;
+
+    // Walk down from the deepest ancestor that is already known.
+    size_t known = relDir.size();
+    uint32_t parent = kRoot;
+    while (true) {
+        known = relDir.rfind('/', known - 1);
+        if (known == std::string_view::npos) {
+            known = 0;
+            break;
+        }
+        if (const auto it = ids.find(std::string(relDir.substr(0, known))); it != ids.end()) {
+            parent = it->second;
+            ++known;
+            break;
+        }
+        if (known == 0) break;
+    }
+
+    while (known < relDir.size()) {
+        size_t slash = relDir.find('/', known);
+        if (slash == std::string_view::npos) slash = relDir.size();
+
+        const auto id = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({parent, nodes[parent].depth + 1, std::string(relDir.substr(known, slash - known))});
+        sums.resize(sums.size() + width);
+        ids.emplace(std::string(relDir.substr(0, slash)), id);
+
+        parent = id;
+        known = slash + 1;
+    }
+    return parent;
+}
+
+void DirTree::add(const uint32_t node, const size_t files, const std::vector<size_t>& counters) {
+    std::lock_guard lock(mutex);
+    nodes[node].files += files;
+    size_t* sum = sums.data() + node * width;
+    for (size_t i = 0; i < width; ++i) sum[i] += counters[i];
+}
+
+void DirTree::rollUp() {
+    for (uint32_t id = static_cast<uint32_t>(nodes.size()); id-- > 1;) {
+        const uint32_t parent = nodes[id].parent;
+        nodes[parent].files += nodes[id].files;
+        for (size_t i = 0; i < width; ++i) sums[parent * width + i] += sums[id * width + i];
+    }
+}
+
+size_t DirTree::total(const uint32_t id) const {
+    size_t sum = 0;
+    for (size_t i = 0; i < width; ++i) sum += sums[id * width + i];
+    return sum;
+}
+
+std::vector<std::vector<uint32_t>> DirTree::children() const {
+    std::vector<std::vector<uint32_t>> result(nodes.size());
+    for (uint32_t id = 1; id < nodes.size(); ++id) result[nodes[id].parent].push_back(id);
+    return result;
+}
@@ -0,0 +1,551 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "DiskUsage.h"
+#include "DirWalk.h"
+#include "LineCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace {
+
+constexpr char kIndexMagic[8] = {'C', 'L', 'I', 'D', 'U', 'I', 'D', 'X'};
+constexpr uint32_t kIndexVersion = 2;
+constexpr uint32_t kNoRecord = std::numeric_limits<uint32_t>::max();
+// Stored for directories that must be listed next time, whatever their mtime.
+constexpr int64_t kStale = std::numeric_limits<int64_t>::min();
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t namesSize;
+};
+static_assert(sizeof(IndexHeader) == 24);
+
+// Records are in breadth-first order from the root, so the subdirectories of
+// a directory are one contiguous run, sorted by name. Names follow the
+// records as one blob.
+struct IndexRecord {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtimeNs;
+    uint64_t bytes;         // files directly in the directory
+    uint64_t allocated;
+    uint64_t files;
+    uint32_t firstChild;
+    uint32_t children;
+    uint32_t nameOffset;
+    uint32_t nameSize;
+};
+static_assert(sizeof(IndexRecord) == 64);
+
+// The previous scan, mmap'ed read-only; shared by all workers without locks.
+class DirIndex {
+public:
+    DirIndex() = default;
+    ~DirIndex() {
+        if (mapped) munmap(mapped, mappedSize);
+    }
+    DirIndex(const DirIndex&) = delete;
+    DirIndex& operator=(const DirIndex&) = delete;
+
+    void load(const std::string& path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(IndexHeader))) {
+            close(fd);
+            return;
+        }
+
+        const auto size = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) return;
+
+        IndexHeader header{};
+        std::memcpy(&header, data, sizeof(header));
+        const bool valid = std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0
+                        && header.version == kIndexVersion
+                        && header.count > 0
+                        && size == sizeof(IndexHeader) + header.count * sizeof(IndexRecord) + header.namesSize;
+        mapped = data;
+        mappedSize = size;
+        if (!valid) return;
+
+        records = reinterpret_cast<const IndexRecord*>(static_cast<const char*>(data) + sizeof(IndexHeader));
+        names = reinterpret_cast<const char*>(records + header.count);
+        if (!wellFormed(header.count, header.namesSize)) {
+            records = nullptr;
+            return;
+        }
+        count = header.count;
+    }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] const IndexRecord& operator[](const uint32_t id) const { return records[id]; }
+
+    [[nodiscard]] std::string_view name(const uint32_t id) const {
+        return {names + records[id].nameOffset, records[id].nameSize};
+    }
+
+    [[nodiscard]] bool matches(const uint32_t id, const struct stat& st) const {
+        const IndexRecord& record = records[id];
+        return record.dev == static_cast<uint64_t>(st.st_dev)
+            && record.ino == static_cast<uint64_t>(st.st_ino)
+            && record.mtimeNs == mtimeNs(st);
+    }
+
+    // The subdirectory `name` of record `parent`, kNoRecord if it was not there.
+    [[nodiscard]] uint32_t child(const uint32_t parent, const std::string_view childName) const {
+        if (parent == kNoRecord) return kNoRecord;
+        uint32_t lo = records[parent].firstChild;
+        uint32_t hi = lo + records[parent].children;
+        while (lo < hi) {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            if (name(mid) < childName) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < records[parent].firstChild + records[parent].children && name(lo) == childName ? lo : kNoRecord;
+    }
+
+private:
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+    const IndexRecord* records = nullptr;
+    const char* names = nullptr;
+    uint32_t count = 0;
+
+    // Child runs must tile the records in order, so a damaged file can
+    // neither loop nor count a directory twice.
+    [[nodiscard]] bool wellFormed(const uint32_t total, const uint64_t namesSize) const {
+        uint64_t expected = 1;
+        for (uint32_t id = 0; id < total; ++id) {
+            const IndexRecord& record = records[id];
+            if (static_cast<uint64_t>(record.nameOffset) + record.nameSize > namesSize) return false;
+            if (record.children == 0) continue;
+            if (record.firstChild != expected) return false;
+            expected += record.children;
+        }
+        return expected == total;
+    }
+};
+
+struct Work {
+    Work* parent = nullptr;
+    std::string name;
+    uint32_t depth = 0;
+    uint32_t id = 0;
+    uint32_t cached = kNoRecord;        // this directory in the previous index
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    int64_t mtimeNs = kStale;
+    uint64_t ownBytes = 0;
+    uint64_t ownAllocated = 0;
+    uint64_t ownFiles = 0;
+    bool listed = false;                // everything inside was seen, safe to reuse
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> allocated{0};
+    std::atomic<uint64_t> files{0};
+    std::atomic<uint32_t> pending{1};   // own listing + children not finished yet
+};
+
+class LinkedFiles;
+
+struct ScanState {
+    DirWalk<Work>& walk;
+    const DirIndex& index;
+    LinkedFiles& links;
+    std::atomic<uint64_t>& dirs;
+    std::atomic<uint64_t>& kept;
+    std::atomic<uint64_t>& bytes;
+    std::atomic<size_t> failures{0};
+};
+
+// The last of a node's tasks to finish hands its totals to the parent. The
+// release half of the decrement publishes the adds made before it; the
+// acquire half lets the last one see every child's contribution.
+void complete(Work* node) {
+    while (node->pending.fetch_sub(1, std::memory_order_acq_rel) == 1 && node->parent) {
+        Work* parent = node->parent;
+        parent->bytes.fetch_add(node->bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        parent->allocated.fetch_add(node->allocated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        parent->files.fetch_add(node->files.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        node = parent;
+    }
+}
+
+// Component-wise path order, without building the strings.
+bool pathLess(const Work* a, const Work* b) {
+    std::vector<const Work*> left, right;
+    for (; a->parent; a = a->parent) left.push_back(a);
+    for (; b->parent; b = b->parent) right.push_back(b);
+    while (!left.empty() && !right.empty()) {
+        if (const int order = left.back()->name.compare(right.back()->name); order != 0) return order < 0;
+        left.pop_back();
+        right.pop_back();
+    }
+    return left.size() < right.size();
+}
+
+// Files with more than one link, keyed by (dev, ino), so each inode counts
+// once however many names it has. Single-link files, nearly all of them,
+// never get here. The size goes to the first directory in path order that
+// holds a link, which keeps reports stable whichever worker got there first;
+// it is added after the walk. Sharded by hash so workers rarely meet on a
+// lock; each shard is an open-addressing table.
+class LinkedFiles {
+public:
+    // True the first time the inode is seen.
+    bool claim(const struct stat& st, Work* dir) {
+        const Link link{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino), dir,
+                        static_cast<uint64_t>(st.st_size), static_cast<uint64_t>(st.st_blocks) * 512};
+        Shard& shard = shards[hash(link) >> (64 - kShardBits)];
+
+        std::lock_guard lock(shard.m);
+        if ((shard.used + 1) * 2 > shard.slots.size()) grow(shard);
+        const size_t mask = shard.slots.size() - 1;
+        for (size_t i = hash(link) & mask;; i = (i + 1) & mask) {
+            Link& slot = shard.slots[i];
+            if (!slot.owner) {
+                slot = link;
+                ++shard.used;
+                return true;
+            }
+            if (slot.dev == link.dev && slot.ino == link.ino) {
+                if (pathLess(dir, slot.owner)) slot.owner = dir;
+                return false;
+            }
+        }
+    }
+
+    // Once the pool is done: adds every file to its owner and the owner's ancestors.
+    void settle() {
+        for (Shard& shard : shards) {
+            for (const Link& link : shard.slots) {
+                if (!link.owner) continue;
+                for (Work* dir = link.owner; dir; dir = dir->parent) {
+                    dir->bytes.fetch_add(link.bytes, std::memory_order_relaxed);
+                    dir->allocated.fetch_add(link.allocated, std::memory_order_relaxed);
+                    dir->files.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+private:
+    struct Link {
+        uint64_t dev = 0;
+        uint64_t ino = 0;
+        Work* owner = nullptr;      // nullptr: empty slot
+        uint64_t bytes = 0;
+        uint64_t allocated = 0;
+    };
+    struct Shard {
+        std::mutex m;
+        std::vector<Link> slots;
+        size_t used = 0;
+    };
+
+    static constexpr unsigned kShardBits = 6;
+    Shard shards[1 << kShardBits];
+
+    static uint64_t hash(const Link& link) {
+        uint64_t z = link.dev * 0x9E3779B97F4A7C15ull ^ link.ino;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static void grow(Shard& shard) {
+        std::vector<Link> old(std::max<size_t>(64, shard.slots.size() * 2));
+        old.swap(shard.slots);
+        const size_t mask = shard.slots.size() - 1;
+        for (const Link& link : old) {
+            if (!link.owner) continue;
+            size_t i = hash(link) & mask;
+            while (shard.slots[i].owner) i = (i + 1) & mask;
+            shard.slots[i] = link;
+        }
+    }
+};
+
+void queueChild(ScanState& state, const size_t worker, Work* node, const int dirFd,
+                const std::string_view name, const uint32_t cached) {
+    Work& child = state.walk.emplace(worker, node, name);
+    child.depth = node->depth + 1;
+    child.cached = cached;
+    state.walk.queue(worker, child, dirFd);
+}
+
+// Own files and subdirectory names from the index, no listing.
+void reuseDir(ScanState& state, const size_t worker, Work* node, const int dirFd) {
+    const IndexRecord& record = state.index[node->cached];
+    node->ownBytes = record.bytes;
+    node->ownAllocated = record.allocated;
+    node->ownFiles = record.files;
+    node->listed = true;
+    for (uint32_t c = record.firstChild; c < record.firstChild + record.children; ++c) {
+        queueChild(state, worker, node, dirFd, state.index.name(c), c);
+    }
+    state.kept.fetch_add(1, std::memory_order_relaxed);
+}
+
+// A directory holding a multi-link file is never reused: its links are sized
+// after the walk by whichever directory owns them, so they are not in its own
+// totals.
+void readDir(ScanState& state, const size_t worker, Work* node, DirReader& dir) {
+    DirReader::Entry entry{};
+    struct stat st{};
+    bool linked = false;
+    while (dir.next(entry)) {
+        unsigned char type = entry.type;
+        if (type == DT_UNKNOWN || type == DT_REG) {
+            if (!statAt(dir.fd(), entry.name.data(), st)) continue;
+            type = IFTODT(st.st_mode);
+        }
+
+        if (type == DT_REG) {
+            if (st.st_nlink > 1) {
+                linked = true;
+                if (state.links.claim(st, node)) state.bytes.fetch_add(static_cast<uint64_t>(st.st_size), std::memory_order_relaxed);
+                continue;
+            }
+            node->ownBytes += static_cast<uint64_t>(st.st_size);
+            node->ownAllocated += static_cast<uint64_t>(st.st_blocks) * 512;
+            ++node->ownFiles;
+        } else if (type == DT_DIR) {
+            queueChild(state, worker, node, dir.fd(), entry.name, state.index.child(node->cached, entry.name));
+        }
+    }
+    node->listed = !dir.failed() && !linked;
+    if (dir.failed()) state.failures.fetch_add(1, std::memory_order_relaxed);
+}
+
+void listDir(ScanState& state, const size_t worker, Work* node, const int fd) {
+    thread_local DirReader dir;
+
+    const bool opened = state.walk.open(dir, node, fd);
+    struct stat st{};
+    if (opened && fstat(dir.fd(), &st) == 0) {
+        node->dev = static_cast<uint64_t>(st.st_dev);
+        node->ino = static_cast<uint64_t>(st.st_ino);
+        node->mtimeNs = mtimeNs(st);
+        if (node->cached != kNoRecord && state.index.matches(node->cached, st)) reuseDir(state, worker, node, dir.fd());
+        else readDir(state, worker, node, dir);
+    } else {
+        state.failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (opened) dir.close();
+
+    node->bytes.fetch_add(node->ownBytes, std::memory_order_relaxed);
+    node->allocated.fetch_add(node->ownAllocated, std::memory_order_relaxed);
+    node->files.fetch_add(node->ownFiles, std::memory_order_relaxed);
+    state.dirs.fetch_add(1, std::memory_order_relaxed);
+    state.bytes.fetch_add(node->ownBytes, std::memory_order_relaxed);
+    complete(node);
+}
+
+bool writeAll(const int fd, const void* data, size_t size) {
+    const auto* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = write(fd, p, size);
+        if (n < 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+std::string DiskUsage::defaultIndexPath(const std::string& root) {
+    return cacheFilePath(root, ".du");
+}
+
+bool DiskUsage::scan(const std::string& root, const size_t threads, const std::string& indexPath) {
+    rootPath = root;
+    while (rootPath.size() > 1 && rootPath.back() == '/') rootPath.pop_back();
+    nodes.clear();
+    stamps.clear();
+    failures = 0;
+    dirsDone = 0;
+    dirsKept = 0;
+    bytesDone = 0;
+
+    const int rootFd = open(rootPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) return false;
+
+    DirIndex index;
+    if (!indexPath.empty()) index.load(indexPath);
+    const int64_t started = nowNs();
+
+    DirWalk<Work> walk(rootPath, threads);
+    LinkedFiles links;
+    ScanState state{walk, index, links, dirsDone, dirsKept, bytesDone};
+
+    Work top;
+    if (!index.empty()) top.cached = 0;
+    walk.run(top, rootFd, [&](const size_t worker, Work* node, const int fd) { listDir(state, worker, node, fd); });
+    failures = state.failures.load();
+    links.settle();
+
+    // Ids are handed out only now; parents can come after their children.
+    uint32_t next = kRoot + 1;
+    for (auto& arena : walk.nodes()) {
+        for (auto& work : arena) work.id = next++;
+    }
+    nodes.reserve(next);
+    stamps.reserve(next);
+    auto keep = [&](Work& work, const uint32_t parent) {
+        nodes.push_back({parent, work.depth, std::move(work.name), work.bytes.load(), work.allocated.load(),
+                         work.files.load()});
+        stamps.push_back({work.dev, work.ino, work.mtimeNs, work.ownBytes, work.ownAllocated, work.ownFiles,
+                          work.listed});
+    };
+    keep(top, kRoot);
+    for (auto& arena : walk.nodes()) {
+        for (auto& work : arena) keep(work, work.parent->id);
+    }
+
+    // A directory changed in the same clock tick as its listing could keep
+    // its mtime; those are listed again next time.
+    for (auto& stamp : stamps) {
+        if (stamp.mtimeNs >= started - 1'000'000'000) stamp.valid = false;
+    }
+    return true;
+}
+
+bool DiskUsage::saveIndex(const std::string& indexPath) const {
+    // Children of each node as one run per parent, sorted by name.
+    std::vector<uint32_t> start(nodes.size() + 1, 0);
+    for (uint32_t id = kRoot + 1; id < nodes.size(); ++id) ++start[nodes[id].parent + 1];
+    for (size_t i = 1; i < start.size(); ++i) start[i] += start[i - 1];
+    std::vector<uint32_t> children(nodes.size() - 1);
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    for (uint32_t id = kRoot + 1; id < nodes.size(); ++id) children[fill[nodes[id].parent]++] = id;
+    for (uint32_t id = 0; id < nodes.size(); ++id) {
+        std::sort(children.begin() + start[id], children.begin() + start[id + 1],
+                  [this](const uint32_t a, const uint32_t b) { return nodes[a].name < nodes[b].name; });
+    }
+
+    std::vector<uint32_t> order = {kRoot};
+    order.reserve(nodes.size());
+    std::vector<IndexRecord> records(nodes.size());
+    std::string names;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const uint32_t id = order[i];
+        const Stamp& stamp = stamps[id];
+        if (names.size() + nodes[id].name.size() > std::numeric_limits<uint32_t>::max()) return false;
+
+        records[i] = {
+            stamp.dev,
+            stamp.ino,
+            stamp.valid ? stamp.mtimeNs : kStale,
+            stamp.bytes,
+            stamp.allocated,
+            stamp.files,
+            static_cast<uint32_t>(order.size()),
+            start[id + 1] - start[id],
+            static_cast<uint32_t>(names.size()),
+            static_cast<uint32_t>(nodes[id].name.size())
+        };
+        if (records[i].children == 0) records[i].firstChild = 0;
+        names += nodes[id].name;
+        order.insert(order.end(), children.begin() + start[id], children.begin() + start[id + 1]);
+    }
+
+    const std::string tmp = indexPath + ".tmp." + std::to_string(getpid());
+    const int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    IndexHeader header{};
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.version = kIndexVersion;
+    header.count = static_cast<uint32_t>(records.size());
+    header.namesSize = names.size();
+
+    const bool ok = writeAll(fd, &header, sizeof(header))
+                 && writeAll(fd, records.data(), records.size() * sizeof(IndexRecord))
+                 && writeAll(fd, names.data(), names.size());
+    close(fd);
+
+    if (!ok || std::rename(tmp.c_str(), indexPath.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void DiskUsage::discount(uint32_t id, const uint64_t bytes, const uint64_t allocated, const uint64_t files) {
+    while (true) {
+        Node& node = nodes[id];
+        node.bytes -= std::min(node.bytes, bytes);
+        node.allocated -= std::min(node.allocated, allocated);
+        node.files -= std::min(node.files, files);
+        if (id == kRoot) return;
+        id = node.parent;
+    }
+}
+
+void DiskUsage::erase(const uint32_t id) {
+    erase(std::vector<uint32_t>{id});
+}
+
+void DiskUsage::erase(const std::vector<uint32_t>& ids) {
+    enum : uint8_t { kUnknown, kGone, kKept };
+    std::vector<uint8_t> state(nodes.size(), kUnknown);
+    for (const uint32_t id : ids) state[id] = kGone;
+
+    // Only the topmost of nested ids comes off the ancestors, or the inner
+    // ones would be taken off twice.
+    for (const uint32_t id : ids) {
+        bool nested = false;
+        for (uint32_t up = id; up != kRoot && !nested;) {
+            up = nodes[up].parent;
+            nested = state[up] == kGone;
+        }
+        if (nested) continue;
+        const Node gone = nodes[id];
+        discount(id, gone.bytes, gone.allocated, gone.files);
+    }
+
+    // Parents can come after their children, so ask each node what is above
+    // it rather than walking down, remembering the answer along the way.
+    if (state[kRoot] == kUnknown) state[kRoot] = kKept;
+    std::vector<uint32_t> chain;
+    for (uint32_t other = 0; other < nodes.size(); ++other) {
+        chain.clear();
+        uint32_t up = other;
+        for (; state[up] == kUnknown; up = nodes[up].parent) chain.push_back(up);
+        for (const uint32_t below : chain) state[below] = state[up];
+        if (state[other] == kGone) nodes[other].bytes = nodes[other].allocated = nodes[other].files = 0;
+    }
+}
+
+std::string DiskUsage::path(uint32_t id) const {
+    std::vector<uint32_t> chain;
+    for (; id != kRoot; id = nodes[id].parent) chain.push_back(id);
+
+    std::string result = rootPath;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (result.empty() || result.back() != '/') result += '/';
+        result += nodes[*it].name;
+    }
+    return result;
+}
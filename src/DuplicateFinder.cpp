@@ -0,0 +1,335 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "DuplicateFinder.h"
+#include "DirReader.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kSample = 4096;
+// Whole-file hashes read this much at a time into a per-thread buffer; a
+// multiple of the 16-byte hash block.
+constexpr size_t kChunk = size_t{1} << 20;
+constexpr size_t kGrain = 64;
+
+constexpr uint64_t kC1 = 0x87C37B91114253D5ull;
+constexpr uint64_t kC2 = 0x4CF5AD432745937Full;
+
+uint64_t rotl(const uint64_t x, const int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDull;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+struct Candidate {
+    std::string path;
+    uint64_t size = 0;
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    Hash128 hash;           // of the sample, then of the whole content
+    bool failed = false;
+};
+
+struct Range {
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// Runs body(i) for every i below count. Ranges are split in halves as
+// workers go, so idle ones always find something to steal.
+template <typename Body>
+void parallelFor(const size_t count, const size_t threads, Body&& body) {
+    if (count == 0) return;
+    WorkStealingPool<Range> pool(threads);
+    pool.run({Range{0, count}}, [&](const size_t worker, Range& range) {
+        while (range.end - range.begin > kGrain) {
+            const size_t mid = range.begin + (range.end - range.begin) / 2;
+            pool.push(worker, Range{mid, range.end});
+            range.end = mid;
+        }
+        for (size_t i = range.begin; i < range.end; ++i) body(i);
+    });
+}
+
+bool readAt(const int fd, unsigned char* out, size_t size, off_t offset) {
+    while (size > 0) {
+        const ssize_t n = pread(fd, out, size, offset);
+        if (n <= 0) return false;
+        out += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+// First and last kSample bytes; the whole file when it is no longer than both.
+bool sampleHash(Candidate& file) {
+    const int fd = open(file.path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    unsigned char buffer[2 * kSample];
+    bool ok;
+    size_t size;
+    if (file.size <= sizeof(buffer)) {
+        size = file.size;
+        ok = readAt(fd, buffer, size, 0);
+    } else {
+        size = sizeof(buffer);
+        ok = readAt(fd, buffer, kSample, 0)
+          && readAt(fd, buffer + kSample, kSample, static_cast<off_t>(file.size - kSample));
+    }
+    close(fd);
+    if (!ok) return false;
+
+    Murmur3 hash;
+    hash.update(buffer, size);
+    file.hash = hash.finish();
+    return true;
+}
+
+bool fullHash(Candidate& file) {
+    const int fd = open(file.path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    thread_local std::unique_ptr<unsigned char[]> buffer;
+    if (!buffer) buffer = std::make_unique<unsigned char[]>(kChunk);
+
+    struct stat st{};
+    bool ok = fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) == file.size;
+#if defined(POSIX_FADV_SEQUENTIAL)
+    if (ok) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    // A file cut short meanwhile ends the read early and counts as unreadable.
+    Murmur3 hash;
+    for (uint64_t offset = 0; ok && offset < file.size; offset += kChunk) {
+        const auto length = static_cast<size_t>(std::min<uint64_t>(kChunk, file.size - offset));
+        ok = readAt(fd, buffer.get(), length, static_cast<off_t>(offset));
+        if (ok) hash.update(buffer.get(), length);
+    }
+    close(fd);
+    if (ok) file.hash = hash.finish();
+    return ok;
+}
+
+// Calls fn(begin, end) for each run of at least two files that `same` puts
+// together; `list` must be sorted so that they are adjacent.
+template <typename Same, typename Fn>
+void forEachRun(std::vector<Candidate>& list, Same&& same, Fn&& fn) {
+    for (size_t begin = 0; begin < list.size();) {
+        size_t end = begin + 1;
+        while (end < list.size() && same(list[begin], list[end])) ++end;
+        if (end - begin > 1) fn(begin, end);
+        begin = end;
+    }
+}
+
+bool byContent(const Candidate& a, const Candidate& b) {
+    if (a.size != b.size) return a.size < b.size;
+    if (a.hash != b.hash) return a.hash < b.hash;
+    return a.path < b.path;
+}
+
+bool sameContent(const Candidate& a, const Candidate& b) {
+    return a.size == b.size && a.hash == b.hash;
+}
+
+}
+
+void Murmur3::update(const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    length += size;
+    for (; size >= 16; p += 16, size -= 16) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, p, sizeof(k1));
+        std::memcpy(&k2, p + 8, sizeof(k2));
+
+        k1 *= kC1;
+        k1 = rotl(k1, 31);
+        k1 *= kC2;
+        h1 ^= k1;
+        h1 = rotl(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52DCE729;
+
+        k2 *= kC2;
+        k2 = rotl(k2, 33);
+        k2 *= kC1;
+        h2 ^= k2;
+        h2 = rotl(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495AB5;
+    }
+    std::memcpy(tail, p, size);
+    tailSize = size;
+}
+
+Hash128 Murmur3::finish() {
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    for (size_t i = tailSize; i-- > 8;) k2 ^= static_cast<uint64_t>(tail[i]) << (8 * (i - 8));
+    for (size_t i = std::min<size_t>(tailSize, 8); i-- > 0;) k1 ^= static_cast<uint64_t>(tail[i]) << (8 * i);
+
+    if (tailSize > 8) {
+        k2 *= kC2;
+        k2 = rotl(k2, 33);
+        k2 *= kC1;
+        h2 ^= k2;
+    }
+    if (tailSize > 0) {
+        k1 *= kC1;
+        k1 = rotl(k1, 31);
+        k1 *= kC2;
+        h1 ^= k1;
+    }
+
+    h1 ^= length;
+    h2 ^= length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    h2 += h1;
+    return {h1, h2};
+}
+
+bool DuplicateFinder::find(const std::string& root, const size_t threads, const uint64_t minSize) {
+    found.clear();
+    failures = 0;
+    seen = 0;
+    done = 0;
+    total = 0;
+    current = Stage::Walking;
+
+    DirReader probe;
+    if (!probe.open(root.c_str())) {
+        current = Stage::Done;
+        return false;
+    }
+    probe.close();
+
+    // 1. Walk, one list per worker.
+    std::atomic<size_t> unreadable{0};
+    WorkStealingPool<std::string> walker(threads);
+    std::vector<std::vector<Candidate>> lists(walker.size());
+    walker.run({root}, [&](const size_t worker, std::string& dirPath) {
+        thread_local DirReader dir;
+        if (!dir.open(dirPath.c_str())) {
+            unreadable.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (dirPath.back() != '/') dirPath += '/';
+
+        DirReader::Entry entry{};
+        struct stat st{};
+        while (dir.next(entry)) {
+            if (entry.type == DT_DIR) {
+                walker.push(worker, dirPath + std::string(entry.name));
+                continue;
+            }
+            if (entry.type != DT_REG && entry.type != DT_UNKNOWN) continue;
+            if (!statAt(dir.fd(), entry.name.data(), st)) continue;
+            if (S_ISDIR(st.st_mode)) {
+                walker.push(worker, dirPath + std::string(entry.name));
+                continue;
+            }
+            if (!S_ISREG(st.st_mode)) continue;
+
+            seen.fetch_add(1, std::memory_order_relaxed);
+            if (static_cast<uint64_t>(st.st_size) < std::max<uint64_t>(minSize, 1)) continue;
+            lists[worker].push_back({dirPath + std::string(entry.name), static_cast<uint64_t>(st.st_size),
+                                     static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino), {}, false});
+        }
+        if (dir.failed()) unreadable.fetch_add(1, std::memory_order_relaxed);
+        dir.close();
+    });
+
+    std::vector<Candidate> files;
+    for (auto& list : lists) {
+        files.insert(files.end(), std::make_move_iterator(list.begin()), std::make_move_iterator(list.end()));
+        list = {};
+    }
+
+    // One entry per inode (hard links share their blocks), then keep only
+    // sizes that occur more than once.
+    std::sort(files.begin(), files.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.size != b.size) return a.size < b.size;
+        if (a.dev != b.dev) return a.dev < b.dev;
+        if (a.ino != b.ino) return a.ino < b.ino;
+        return a.path < b.path;
+    });
+    files.erase(std::unique(files.begin(), files.end(), [](const Candidate& a, const Candidate& b) {
+        return a.size == b.size && a.dev == b.dev && a.ino == b.ino;
+    }), files.end());
+
+    std::vector<Candidate> sampled;
+    forEachRun(files, [](const Candidate& a, const Candidate& b) { return a.size == b.size; },
+               [&](const size_t begin, const size_t end) {
+        sampled.insert(sampled.end(), std::make_move_iterator(files.begin() + static_cast<ptrdiff_t>(begin)),
+                       std::make_move_iterator(files.begin() + static_cast<ptrdiff_t>(end)));
+    });
+    files = {};
+
+    // 2. Head and tail.
+    current = Stage::Sampling;
+    total = sampled.size();
+    parallelFor(sampled.size(), threads, [&](const size_t i) {
+        sampled[i].failed = !sampleHash(sampled[i]);
+        done.fetch_add(1, std::memory_order_relaxed);
+    });
+    size_t lost = static_cast<size_t>(std::count_if(sampled.begin(), sampled.end(), [](const Candidate& c) { return c.failed; }));
+    std::erase_if(sampled, [](const Candidate& c) { return c.failed; });
+    std::sort(sampled.begin(), sampled.end(), byContent);
+
+    auto addGroup = [this](std::vector<Candidate>& list, const size_t begin, const size_t end) {
+        DuplicateGroup group{list[begin].size, {}};
+        for (size_t i = begin; i < end; ++i) group.paths.push_back(std::move(list[i].path));
+        found.push_back(std::move(group));
+    };
+
+    // Files up to two samples long were hashed whole already.
+    std::vector<Candidate> hashing;
+    forEachRun(sampled, sameContent, [&](const size_t begin, const size_t end) {
+        if (sampled[begin].size <= 2 * kSample) {
+            addGroup(sampled, begin, end);
+            return;
+        }
+        hashing.insert(hashing.end(), std::make_move_iterator(sampled.begin() + static_cast<ptrdiff_t>(begin)),
+                       std::make_move_iterator(sampled.begin() + static_cast<ptrdiff_t>(end)));
+    });
+    sampled = {};
+
+    // 3. Whole files.
+    current = Stage::Hashing;
+    done = 0;
+    total = hashing.size();
+    parallelFor(hashing.size(), threads, [&](const size_t i) {
+        hashing[i].failed = !fullHash(hashing[i]);
+        done.fetch_add(1, std::memory_order_relaxed);
+    });
+    lost += static_cast<size_t>(std::count_if(hashing.begin(), hashing.end(), [](const Candidate& c) { return c.failed; }));
+    std::erase_if(hashing, [](const Candidate& c) { return c.failed; });
+    std::sort(hashing.begin(), hashing.end(), byContent);
+    forEachRun(hashing, sameContent, [&](const size_t begin, const size_t end) { addGroup(hashing, begin, end); });
+
+    std::sort(found.begin(), found.end(), [](const DuplicateGroup& a, const DuplicateGroup& b) {
+        return a.wasted() != b.wasted() ? a.wasted() > b.wasted() : a.paths.front() < b.paths.front();
+    });
+    failures = unreadable.load() + lost;
+    current = Stage::Done;
+    return true;
+}
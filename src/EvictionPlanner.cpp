@@ -0,0 +1,160 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "EvictionPlanner.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+
+bool usedBefore(const EvictionCandidate& a, const EvictionCandidate& b) {
+    return a.lastUsed != b.lastUsed ? a.lastUsed < b.lastUsed : a.path < b.path;
+}
+
+// The oldest candidates that add up to `target`, and not one more: the top
+// is the most recently used file kept, and it goes as soon as the others
+// reach the target without it.
+class LruHeap {
+public:
+    explicit LruHeap(const uint64_t target) : target(target) {}
+
+    // Lets callers skip building a path for a file that cannot make the plan.
+    [[nodiscard]] bool wants(const int64_t lastUsed) const {
+        if (target == 0) return false;
+        return bytes < target || lastUsed <= heap.front().lastUsed;
+    }
+
+    void push(EvictionCandidate candidate) {
+        bytes += candidate.bytes;
+        heap.push_back(std::move(candidate));
+        std::push_heap(heap.begin(), heap.end(), usedBefore);
+        while (bytes - heap.front().bytes >= target) {
+            bytes -= heap.front().bytes;
+            std::pop_heap(heap.begin(), heap.end(), usedBefore);
+            heap.pop_back();
+        }
+    }
+
+    // Oldest first.
+    std::vector<EvictionCandidate> take() {
+        std::sort_heap(heap.begin(), heap.end(), usedBefore);
+        bytes = 0;
+        return std::move(heap);
+    }
+
+    [[nodiscard]] uint64_t size() const { return bytes; }
+
+private:
+    uint64_t target;
+    uint64_t bytes = 0;
+    std::vector<EvictionCandidate> heap;
+};
+
+}
+
+EvictionPlan EvictionPlanner::plan(const CacheCatalog& catalog, const std::vector<size_t>& rules,
+                                   const uint64_t target, const size_t threads) {
+    seen = 0;
+    EvictionPlan result;
+    result.target = target;
+
+    std::vector<std::vector<std::string>> owned = catalog.claim();
+    for (size_t rule = 0; rule < owned.size(); ++rule) {
+        if (!rules.empty() && std::find(rules.begin(), rules.end(), rule) == rules.end()) continue;
+        for (auto& path : owned[rule]) {
+            result.entries.push_back(std::move(path));
+            result.ruleOf.push_back(rule);
+        }
+    }
+
+    std::vector<uint32_t> tasks(result.entries.size());
+    for (size_t i = 0; i < tasks.size(); ++i) tasks[i] = static_cast<uint32_t>(i);
+
+    const auto now = static_cast<int64_t>(std::time(nullptr));
+    WorkStealingPool<uint32_t> pool(threads);
+    std::vector<LruHeap> heaps(pool.size(), LruHeap(target));
+    std::vector<uint64_t> available(pool.size(), 0);
+    std::vector<size_t> unreadable(pool.size(), 0);
+
+    pool.run(tasks, [&](const size_t worker, const uint32_t& entry) {
+        const std::string& root = result.entries[entry];
+        const int64_t minAge = catalog.rules()[result.ruleOf[entry]].minAge;
+
+        auto consider = [&](const struct stat& st, const auto& pathOf) {
+            if (S_ISDIR(st.st_mode)) return;
+            seen.fetch_add(1, std::memory_order_relaxed);
+            const auto bytes = static_cast<uint64_t>(st.st_blocks) * 512;
+            const int64_t used = lastUse(st);
+            if (bytes == 0 || st.st_nlink > 1 || now - used < minAge) return;
+
+            available[worker] += bytes;
+            if (heaps[worker].wants(used)) heaps[worker].push({pathOf(), bytes, used, entry});
+        };
+
+        struct stat st{};
+        if (lstat(root.c_str(), &st) != 0) {
+            ++unreadable[worker];
+            return;
+        }
+        if (!S_ISDIR(st.st_mode)) {
+            consider(st, [&root] { return root; });
+            return;
+        }
+        unreadable[worker] += walkTree(root, [&](const std::string& dir, const std::string_view name, const struct stat& child) {
+            consider(child, [&] { return dir + std::string(name); });
+        });
+    });
+
+    // What one worker dropped is newer than all it kept, so the union of the
+    // worker heaps still holds the oldest files overall.
+    LruHeap merged(target);
+    for (auto& heap : heaps) {
+        for (auto& candidate : heap.take()) {
+            if (merged.wants(candidate.lastUsed)) merged.push(std::move(candidate));
+        }
+    }
+    result.bytes = merged.size();
+    result.files = merged.take();
+
+    for (size_t w = 0; w < pool.size(); ++w) {
+        result.available += available[w];
+        result.unreadable += unreadable[w];
+    }
+    result.considered = seen.load();
+    return result;
+}
+
+uint64_t EvictionPlanner::execute(const EvictionPlan& plan) {
+    removed = 0;
+    freed = 0;
+    failed = 0;
+
+    std::vector<std::pair<std::string, uint32_t>> parents;
+    for (const auto& file : plan.files) {
+        if (unlink(file.path.c_str()) != 0) {
+            if (errno != ENOENT) ++failed;
+            continue;
+        }
+        removed.fetch_add(1, std::memory_order_relaxed);
+        freed.fetch_add(file.bytes, std::memory_order_relaxed);
+        parents.emplace_back(file.path.substr(0, file.path.rfind('/')), file.entry);
+    }
+
+    // Deepest first, so a directory is tried after everything below it.
+    std::sort(parents.begin(), parents.end(), [](const auto& a, const auto& b) {
+        return a.first.size() != b.first.size() ? a.first.size() > b.first.size() : a.first < b.first;
+    });
+    parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+    for (auto [dir, entry] : parents) {
+        const std::string& root = plan.entries[entry];
+        while (dir.size() > root.size() && dir.starts_with(root) && dir[root.size()] == '/') {
+            if (rmdir(dir.c_str()) != 0) break;
+            dir.resize(dir.rfind('/'));
+        }
+    }
+    return freed.load();
+}
@@ -0,0 +1,49 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "FileSniffer.h"
+#include "LineCounter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kSniffBytes = 4096;
+constexpr size_t kMarkerBytes = 2048;
+constexpr size_t kMarkerLines = 12;
+constexpr size_t kMinifiedMinBytes = 1024;
+constexpr size_t kMinifiedLine = 300;
+
+// Compared against the lower-cased head.
+constexpr std::string_view kMarkers[] = {
+    "generated by", "code generated", "file is generated", "automatically generated",
+    "autogenerated file", "auto-generated file", "@generated",
+    "do not edit.", "do not edit!", "do not edit\n", "do not edit this file"
+};
+
+}
+
+FileKind sniffFile(const std::string_view content) {
+    const std::string_view head = content.substr(0, kSniffBytes);
+    if (std::memchr(head.data(), '\0', head.size())) return FileKind::Binary;
+
+    // Generators stamp the top of the file; deeper down "generated by" is
+    // just as likely to be prose about a constructor.
+    char lower[kMarkerBytes];
+    size_t markerBytes = 0;
+    for (size_t lines = 0; markerBytes < std::min(head.size(), kMarkerBytes) && lines < kMarkerLines; ++markerBytes) {
+        lower[markerBytes] = static_cast<char>(std::tolower(static_cast<unsigned char>(head[markerBytes])));
+        lines += head[markerBytes] == '\n';
+    }
+    const std::string_view top(lower, markerBytes);
+    for (const auto marker : kMarkers) {
+        if (top.find(marker) != std::string_view::npos) return FileKind::Generated;
+    }
+
+    if (head.size() >= kMinifiedMinBytes && head.size() / (countNewlines(head.data(), head.size()) + 1) >= kMinifiedLine) {
+        return FileKind::Minified;
+    }
+    return FileKind::Source;
+}
@@ -0,0 +1,187 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "GitIndex.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr size_t kHeaderSize = 12;
+constexpr size_t kStatSize = 40;
+constexpr uint16_t kExtendedFlag = 0x4000;
+constexpr uint16_t kStageMask = 0x3000;
+constexpr uint16_t kNameMask = 0x0FFF;
+constexpr uint32_t kRegularFile = 0100000;
+constexpr uint32_t kTypeMask = 0170000;
+
+uint32_t be32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16
+         | static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+uint16_t be16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+std::string readText(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+std::string trimmed(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    std::string out(s);
+    for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+// `objectformat = sha256` in the [extensions] section of .git/config; git
+// matches section and key names case-insensitively. Anything else is sha1.
+bool usesSha256(const std::string& config) {
+    std::istringstream lines(config);
+    bool inExtensions = false;
+    for (std::string line; std::getline(lines, line);) {
+        if (const size_t comment = line.find_first_of("#;"); comment != std::string::npos) line.erase(comment);
+        const std::string text = trimmed(line);
+        if (text.empty()) continue;
+        if (text.front() == '[') {
+            const size_t close = text.find(']');
+            inExtensions = close != std::string::npos && trimmed(std::string_view(text).substr(1, close - 1)) == "extensions";
+            continue;
+        }
+        const size_t eq = text.find('=');
+        if (!inExtensions || eq == std::string::npos) continue;
+        if (trimmed(std::string_view(text).substr(0, eq)) != "objectformat") continue;
+
+        std::string value = trimmed(std::string_view(text).substr(eq + 1));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') value = value.substr(1, value.size() - 2);
+        return value == "sha256";
+    }
+    return false;
+}
+
+}
+
+std::string GitIndex::indexPath(const std::string& root) {
+    const std::string dotGit = root + "/.git";
+
+    struct stat st{};
+    if (stat(dotGit.c_str(), &st) != 0) return {};
+    if (S_ISDIR(st.st_mode)) return dotGit;
+
+    std::string text = readText(dotGit);
+    if (text.rfind("gitdir:", 0) != 0) return {};
+    text.erase(0, 7);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.erase(0, 1);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+    if (text.empty()) return {};
+    return text.front() == '/' ? text : root + "/" + text;
+}
+
+std::string GitIndex::commonDir(const std::string& gitDir) {
+    std::string text = readText(gitDir + "/commondir");
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+    if (text.empty()) return gitDir;
+    return text.front() == '/' ? text : gitDir + "/" + text;
+}
+
+bool GitIndex::load(const std::string& root) {
+    const std::string gitDir = indexPath(root);
+    if (gitDir.empty()) return false;
+
+    const int fd = open((gitDir + "/index").c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderSize)) {
+        close(fd);
+        return false;
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    // Repositories created with --object-format=sha256 use 32-byte ids.
+    hashSize = usesSha256(readText(commonDir(gitDir) + "/config")) ? 32 : 20;
+
+    const bool ok = parse(static_cast<const unsigned char*>(data), size);
+    munmap(data, size);
+    return ok;
+}
+
+bool GitIndex::parse(const unsigned char* data, const size_t total) {
+    if (std::memcmp(data, "DIRC", 4) != 0) return false;
+    const uint32_t version = be32(data + 4);
+    if (version < 2 || version > 4) return false;
+    const uint32_t count = be32(data + 8);
+
+    pool.clear();
+    offsets.assign(1, 0);
+    pool.reserve(static_cast<size_t>(count) * 32);
+    offsets.reserve(static_cast<size_t>(count) + 1);
+
+    std::string previous;
+    size_t pos = kHeaderSize;
+
+    for (uint32_t n = 0; n < count; ++n) {
+        const size_t start = pos;
+        if (pos + kStatSize + hashSize + 2 > total) return false;
+
+        const uint32_t mode = be32(data + pos + 24);
+        pos += kStatSize + hashSize;
+        const uint16_t flags = be16(data + pos);
+        pos += 2;
+        if (version >= 3 && (flags & kExtendedFlag)) pos += 2;
+
+        std::string_view name;
+        if (version == 4) {
+            size_t strip = 0;
+            if (pos >= total) return false;
+            unsigned char byte = data[pos++];
+            strip = byte & 0x7F;
+            while (byte & 0x80) {
+                if (pos >= total) return false;
+                byte = data[pos++];
+                strip = ((strip + 1) << 7) | (byte & 0x7F);
+            }
+
+            const auto* end = static_cast<const unsigned char*>(std::memchr(data + pos, 0, total - pos));
+            if (!end || strip > previous.size()) return false;
+            previous.resize(previous.size() - strip);
+            previous.append(reinterpret_cast<const char*>(data + pos), static_cast<size_t>(end - (data + pos)));
+            pos = static_cast<size_t>(end - data) + 1;
+            name = previous;
+        } else {
+            size_t length = flags & kNameMask;
+            if (length == kNameMask) {
+                const auto* end = static_cast<const unsigned char*>(std::memchr(data + pos, 0, total - pos));
+                if (!end) return false;
+                length = static_cast<size_t>(end - (data + pos));
+            }
+            if (pos + length > total) return false;
+            name = std::string_view(reinterpret_cast<const char*>(data + pos), length);
+            pos = start + ((pos - start + length + 8) & ~static_cast<size_t>(7));
+        }
+
+        if ((mode & kTypeMask) != kRegularFile) continue;
+        if ((flags & kStageMask) != 0 && size() > 0 && path(size() - 1) == name) continue;
+
+        pool.append(name);
+        offsets.push_back(static_cast<uint32_t>(pool.size()));
+    }
+
+    return true;
+}
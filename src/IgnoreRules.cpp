@@ -0,0 +1,174 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "IgnoreRules.h"
+#include <algorithm>
+#include <fstream>
+
+namespace {
+
+bool hasWildcard(const std::string_view s) {
+    return s.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+// Matches a [...] class at pattern[p]; on success moves p past the ']'.
+bool matchClass(const std::string_view pattern, size_t& p, const char c) {
+    size_t i = p + 1;
+    bool negate = false;
+    if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^')) {
+        negate = true;
+        ++i;
+    }
+
+    bool found = false;
+    bool first = true;
+    for (; i < pattern.size() && (pattern[i] != ']' || first); first = false) {
+        char lo = pattern[i];
+        if (lo == '\\' && i + 1 < pattern.size()) lo = pattern[++i];
+        ++i;
+
+        char hi = lo;
+        if (i + 1 < pattern.size() && pattern[i] == '-' && pattern[i + 1] != ']') {
+            hi = pattern[i + 1];
+            i += 2;
+        }
+        if (lo <= c && c <= hi) found = true;
+    }
+
+    if (i >= pattern.size()) return false;
+    p = i + 1;
+    return found != negate;
+}
+
+}
+
+bool IgnoreRules::globMatch(const std::string_view pattern, const std::string_view text) {
+    size_t p = 0;
+    size_t t = 0;
+
+    while (p < pattern.size()) {
+        const char pc = pattern[p];
+
+        if (pc == '*') {
+            if (p + 1 < pattern.size() && pattern[p + 1] == '*') {
+                const std::string_view rest = pattern.substr(p + 2);
+                if (!rest.empty() && rest.front() == '/') {
+                    const std::string_view after = rest.substr(1);
+                    if (globMatch(after, text.substr(t))) return true;
+                    for (size_t s = t; s < text.size(); ++s) {
+                        if (text[s] == '/' && globMatch(after, text.substr(s + 1))) return true;
+                    }
+                    return false;
+                }
+                for (size_t s = t; s <= text.size(); ++s) {
+                    if (globMatch(rest, text.substr(s))) return true;
+                }
+                return false;
+            }
+
+            const std::string_view rest = pattern.substr(p + 1);
+            for (size_t s = t; s <= text.size(); ++s) {
+                if (globMatch(rest, text.substr(s))) return true;
+                if (s < text.size() && text[s] == '/') break;
+            }
+            return false;
+        }
+
+        if (t == text.size()) return false;
+
+        if (pc == '?') {
+            if (text[t] == '/') return false;
+        } else if (pc == '[') {
+            if (text[t] == '/' || !matchClass(pattern, p, text[t])) return false;
+            ++t;
+            continue;
+        } else {
+            char literal = pc;
+            if (pc == '\\' && p + 1 < pattern.size()) literal = pattern[++p];
+            if (literal != text[t]) return false;
+        }
+        ++p;
+        ++t;
+    }
+
+    return t == text.size();
+}
+
+void IgnoreRules::addLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    while (!line.empty() && line.back() == ' ' && !(line.size() > 1 && line[line.size() - 2] == '\\')) {
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line.front() == '#') return;
+
+    Pattern pattern;
+    if (line.front() == '!') {
+        pattern.negate = true;
+        line.remove_prefix(1);
+    } else if (line.front() == '\\' && line.size() > 1 && (line[1] == '!' || line[1] == '#')) {
+        line.remove_prefix(1);
+    }
+
+    if (!line.empty() && line.back() == '/') {
+        pattern.dirOnly = true;
+        line.remove_suffix(1);
+    }
+    if (line.empty()) return;
+
+    pattern.anchored = line.find('/') != std::string_view::npos;
+    if (line.front() == '/') line.remove_prefix(1);
+    if (line.empty()) return;
+
+    if (!hasWildcard(line)) {
+        pattern.kind = Kind::Literal;
+    } else if (line.front() == '*' && !pattern.anchored && !hasWildcard(line.substr(1))) {
+        pattern.kind = Kind::Suffix;
+        line.remove_prefix(1);
+    }
+
+    pattern.glob = line;
+    anchored |= pattern.anchored;
+    patterns.push_back(std::move(pattern));
+}
+
+bool IgnoreRules::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) addLine(line);
+    return true;
+}
+
+IgnoreRules::Verdict IgnoreRules::match(const std::string_view relPath, const std::string_view name,
+                                        const bool isDir) const {
+    for (auto it = patterns.rbegin(); it != patterns.rend(); ++it) {
+        if (it->dirOnly && !isDir) continue;
+
+        const std::string_view target = it->anchored ? relPath : name;
+        bool hit = false;
+        switch (it->kind) {
+            case Kind::Literal: hit = target == it->glob; break;
+            case Kind::Suffix:  hit = target.ends_with(it->glob); break;
+            case Kind::Glob:    hit = globMatch(it->glob, target); break;
+        }
+        if (hit) return it->negate ? Verdict::Include : Verdict::Ignore;
+    }
+    return Verdict::None;
+}
+
+bool IgnoreNode::isIgnored(const IgnoreNode* node, const std::string_view relPath,
+                           const std::string_view name, const bool isDir) {
+    for (; node; node = node->parent.get()) {
+        std::string_view local = relPath;
+        if (!node->base.empty()) local.remove_prefix(std::min(local.size(), node->base.size() + 1));
+
+        switch (node->rules.match(local, name, isDir)) {
+            case IgnoreRules::Verdict::Ignore:  return true;
+            case IgnoreRules::Verdict::Include: return false;
+            case IgnoreRules::Verdict::None:    break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,115 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "LangTable.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+std::string trimmed(const std::string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) --end;
+    return std::string(text.substr(begin, end - begin));
+}
+
+}
+
+LangTable::LangTable() {
+    languages.reserve(kBuiltinLangs.size());
+    for (const auto& builtin : kBuiltinLangs) {
+        LangConfig config;
+        config.key = builtin.key;
+        config.name = builtin.name;
+        for (const std::string_view ext : builtin.extensions) {
+            if (!ext.empty()) config.extension.emplace_back(ext);
+        }
+        languages.push_back(std::move(config));
+    }
+}
+
+LangId LangTable::find(const std::string_view extension) const {
+    if (extension.empty()) return kNoLang;
+    if (!userExtensions.empty()) {
+        if (const auto it = userExtensions.find(extension); it != userExtensions.end()) return it->second;
+    }
+    return builtinLangOf(extension);
+}
+
+LangId LangTable::findKey(const std::string_view key) const {
+    for (size_t id = 0; id < languages.size(); ++id) {
+        if (languages[id].key == key) return static_cast<LangId>(id);
+    }
+    return kNoLang;
+}
+
+uint32_t LangTable::signature() const {
+    uint32_t hash = extHash("");
+    for (const auto& config : languages) {
+        for (const auto& ext : config.extension) {
+            for (const unsigned char c : config.key + ext) hash = (hash ^ c) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool LangTable::addLanguage(const std::string& spec) {
+    const size_t eq = spec.find('=');
+    const size_t colon = spec.find(':', eq == std::string::npos ? 0 : eq);
+    if (eq == std::string::npos || colon == std::string::npos) return false;
+
+    // Spaces around the separators go; the ones inside a name ("Objective C") stay.
+    const std::string key = trimmed(std::string_view(spec).substr(0, eq));
+    const std::string name = trimmed(std::string_view(spec).substr(eq + 1, colon - eq - 1));
+    if (key.empty() || name.empty()) return false;
+
+    std::vector<std::string> extensions;
+    size_t start = colon + 1;
+    while (start <= spec.size()) {
+        const size_t comma = std::min(spec.find(',', start), spec.size());
+        std::string ext = trimmed(std::string_view(spec).substr(start, comma - start));
+        if (!ext.empty()) {
+            if (ext.front() != '.') ext.insert(ext.begin(), '.');
+            extensions.push_back(std::move(ext));
+        }
+        start = comma + 1;
+    }
+    if (extensions.empty()) return false;
+
+    LangId id = findKey(key);
+    if (id == kNoLang) {
+        if (languages.size() >= kNoLang) return false;
+        id = static_cast<LangId>(languages.size());
+        languages.push_back({{}, name, key});
+    }
+
+    for (auto& ext : extensions) {
+        userExtensions[ext] = id;
+        languages[id].extension.push_back(std::move(ext));
+    }
+    return true;
+}
+
+bool LangTable::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return true;
+
+    bool ok = true;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (const size_t hash = line.find('#'); hash != std::string::npos) line.erase(hash);
+        if (!trimmed(line).empty()) ok = addLanguage(line) && ok;
+    }
+    return ok;
+}
+
+std::string LangTable::defaultConfigPath() {
+    if (const char* xdg = getenv("XDG_CONFIG_HOME"); xdg && *xdg) return std::string(xdg) + "/cliutils/languages";
+    if (const char* home = getenv("HOME"); home && *home) return std::string(home) + "/.config/cliutils/languages";
+    return {};
+}
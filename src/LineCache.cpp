@@ -0,0 +1,183 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "LineCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'L', 'I', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t kVersion = 4;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t signature;
+    uint64_t count;
+};
+static_assert(sizeof(CacheHeader) == 24);
+
+bool keyLess(const CacheRecord& a, const CacheRecord& b) {
+    return a.dev != b.dev ? a.dev < b.dev : a.ino < b.ino;
+}
+
+bool sameKey(const CacheRecord& a, const CacheRecord& b) {
+    return a.dev == b.dev && a.ino == b.ino;
+}
+
+uint64_t fnv1a(const std::string& s) {
+    uint64_t h = 1469598103934665603ull;
+    for (const unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool writeAll(const int fd, const void* data, size_t size) {
+    const auto* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = write(fd, p, size);
+        if (n < 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}
+
+LineCache::LineCache(const std::string& root, const uint32_t tableSignature)
+    : path(cacheFilePath(root, ".lines")), signature(tableSignature) {
+    load();
+}
+
+LineCache::~LineCache() {
+    if (mapped) munmap(mapped, mappedSize);
+}
+
+std::string cacheFilePath(const std::string& root, const std::string& extension) {
+    std::error_code ec;
+    fs::path absolute = fs::weakly_canonical(fs::absolute(root, ec), ec);
+    if (ec) absolute = root;
+
+    fs::path dir;
+    if (const char* xdg = getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        dir = fs::path(xdg) / "cliutils";
+    } else if (const char* home = getenv("HOME"); home && *home) {
+        dir = fs::path(home) / ".cache" / "cliutils";
+    } else {
+        return (absolute / ".cliutils-cache").string() + extension;
+    }
+
+    fs::create_directories(dir, ec);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx",
+                  static_cast<unsigned long long>(fnv1a(absolute.string())));
+    return (dir / name).string() + extension;
+}
+
+void LineCache::load() {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CacheHeader))) {
+        close(fd);
+        return;
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return;
+
+    CacheHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    const bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+                    && header.version == kVersion
+                    && header.signature == signature
+                    && header.count == (size - sizeof(CacheHeader)) / sizeof(CacheRecord)
+                    && (size - sizeof(CacheHeader)) % sizeof(CacheRecord) == 0;
+    if (!valid) {
+        munmap(data, size);
+        return;
+    }
+
+    mapped = data;
+    mappedSize = size;
+    records = reinterpret_cast<const CacheRecord*>(static_cast<const char*>(data) + sizeof(CacheHeader));
+    count = header.count;
+}
+
+CacheRecord LineCache::makeRecord(const struct stat& st, const LineStats& stats, const uint32_t lang,
+                                  const FileKind kind, const bool counted, const std::optional<uint64_t> hash) {
+    return {
+        static_cast<uint64_t>(st.st_dev),
+        static_cast<uint64_t>(st.st_ino),
+        static_cast<uint64_t>(st.st_size),
+        mtimeNs(st),
+        stats.lines,
+        stats.code,
+        stats.comment,
+        hash.value_or(0),
+        lang,
+        static_cast<uint8_t>(kind),
+        static_cast<uint8_t>(counted),
+        static_cast<uint8_t>(hash.has_value()),
+        0
+    };
+}
+
+const CacheRecord* LineCache::find(const struct stat& st, const uint32_t lang) const {
+    const CacheRecord key = makeRecord(st, {}, lang);
+    const CacheRecord* end = records + count;
+    const CacheRecord* it = std::lower_bound(records, end, key, keyLess);
+
+    if (it == end || !sameKey(*it, key)) return nullptr;
+    if (it->size != key.size || it->mtimeNs != key.mtimeNs || it->lang != lang) return nullptr;
+    return it;
+}
+
+bool LineCache::save(std::vector<CacheRecord> fresh, const bool keepUnseen) const {
+    std::sort(fresh.begin(), fresh.end(), keyLess);
+    fresh.erase(std::unique(fresh.begin(), fresh.end(), sameKey), fresh.end());
+
+    std::vector<CacheRecord> merged;
+    if (keepUnseen && count > 0) {
+        merged.reserve(fresh.size() + count);
+        std::set_union(fresh.begin(), fresh.end(), records, records + count,
+                       std::back_inserter(merged), keyLess);
+    } else {
+        merged = std::move(fresh);
+    }
+
+    const std::string tmp = path + ".tmp." + std::to_string(getpid());
+    const int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.signature = signature;
+    header.count = merged.size();
+
+    const bool ok = writeAll(fd, &header, sizeof(header))
+                 && writeAll(fd, merged.data(), merged.size() * sizeof(CacheRecord));
+    close(fd);
+
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
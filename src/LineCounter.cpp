@@ -0,0 +1,166 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "LineCounter.h"
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CLIUTILS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CLIUTILS_NEON 1
+#endif
+
+namespace {
+
+constexpr off_t kMmapThreshold = 256 * 1024;
+constexpr size_t kInitialBuffer = 64 * 1024;
+
+size_t countScalar(const char* data, const size_t size) {
+    return static_cast<size_t>(std::count(data, data + size, '\n'));
+}
+
+#if defined(CLIUTILS_X86)
+// Byte lanes count matches as 0 - 0xFF per hit; flushing through SAD every
+// 255 blocks keeps them from overflowing.
+size_t countSse2(const char* data, const size_t size) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    size_t total = 0;
+    size_t i = 0;
+
+    while (i + 16 <= size) {
+        __m128i acc = zero;
+        const size_t blocks = std::min<size_t>(255, (size - i) / 16);
+        for (size_t b = 0; b < blocks; ++b, i += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(chunk, newline));
+        }
+        const __m128i sums = _mm_sad_epu8(acc, zero);
+        total += static_cast<size_t>(_mm_cvtsi128_si64(sums))
+               + static_cast<size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+    }
+
+    return total + countScalar(data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+size_t countAvx2(const char* data, const size_t size) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i zero = _mm256_setzero_si256();
+    size_t total = 0;
+    size_t i = 0;
+
+    while (i + 32 <= size) {
+        __m256i acc = zero;
+        const size_t blocks = std::min<size_t>(255, (size - i) / 32);
+        for (size_t b = 0; b < blocks; ++b, i += 32) {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(chunk, newline));
+        }
+        const __m256i sums = _mm256_sad_epu8(acc, zero);
+        total += static_cast<size_t>(_mm256_extract_epi64(sums, 0))
+               + static_cast<size_t>(_mm256_extract_epi64(sums, 1))
+               + static_cast<size_t>(_mm256_extract_epi64(sums, 2))
+               + static_cast<size_t>(_mm256_extract_epi64(sums, 3));
+    }
+
+    return total + countSse2(data + i, size - i);
+}
+#endif
+
+#if defined(CLIUTILS_NEON)
+size_t countNeon(const char* data, const size_t size) {
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t total = 0;
+    size_t i = 0;
+
+    while (i + 16 <= size) {
+        uint8x16_t acc = vdupq_n_u8(0);
+        const size_t blocks = std::min<size_t>(255, (size - i) / 16);
+        for (size_t b = 0; b < blocks; ++b, i += 16) {
+            acc = vsubq_u8(acc, vceqq_u8(vld1q_u8(bytes + i), newline));
+        }
+        total += vaddlvq_u8(acc);
+    }
+
+    return total + countScalar(data + i, size - i);
+}
+#endif
+
+using CountFn = size_t (*)(const char*, size_t);
+
+CountFn selectKernel() {
+#if defined(CLIUTILS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return countAvx2;
+    return countSse2;
+#elif defined(CLIUTILS_NEON)
+    return countNeon;
+#else
+    return countScalar;
+#endif
+}
+
+bool readSmall(const int fd, const std::function<void(std::string_view)>& consume) {
+    thread_local std::vector<char> buffer(kInitialBuffer);
+
+    size_t used = 0;
+    while (true) {
+        if (used == buffer.size()) buffer.resize(buffer.size() * 2);
+        const ssize_t n = pread(fd, buffer.data() + used, buffer.size() - used, static_cast<off_t>(used));
+        if (n < 0) return false;
+        if (n == 0) break;
+        used += static_cast<size_t>(n);
+    }
+
+    consume(std::string_view(buffer.data(), used));
+    return true;
+}
+
+}
+
+size_t countNewlines(const char* data, const size_t size) {
+    static const CountFn kernel = selectKernel();
+    return kernel(data, size);
+}
+
+size_t countLines(const std::string_view content) {
+    if (content.empty()) return 0;
+    return countNewlines(content.data(), content.size()) + (content.back() != '\n' ? 1 : 0);
+}
+
+bool readFile(const std::string& path, const std::function<void(std::string_view)>& consume) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+
+    if (S_ISREG(st.st_mode) && st.st_size >= kMmapThreshold) {
+        const auto size = static_cast<size_t>(st.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            close(fd);
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            consume(std::string_view(static_cast<const char*>(mapped), size));
+            munmap(mapped, size);
+            return true;
+        }
+    }
+
+    const bool ok = readSmall(fd, consume);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,296 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "LineLexer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t kNewline = 1;
+constexpr uint8_t kSpace = 2;
+constexpr uint8_t kSpecial = 4;
+constexpr uint8_t kQuote = 8;
+constexpr uint8_t kEscape = 16;
+constexpr uint8_t kBlockEnd = 32;
+
+enum class Match { No, Yes, NeedMore };
+
+// GCC/Clang vector extensions compile to SSE2 on x86-64 and NEON on arm64.
+using Bytes16 = uint8_t __attribute__((vector_size(16)));
+
+template <size_t N>
+struct StopSet {
+    Bytes16 splat[N] = {};
+    size_t count = 0;
+
+    void add(const char c) {
+        for (size_t k = 0; k < count; ++k) {
+            if (splat[k][0] == static_cast<uint8_t>(c)) return;
+        }
+        Bytes16 v;
+        for (size_t b = 0; b < 16; ++b) v[b] = static_cast<uint8_t>(c);
+        splat[count++] = v;
+    }
+};
+
+// Index of the first byte of [data + from, data + size) that is in `stops`,
+// or `size`. 16 bytes per step; the comparison mask is read as two
+// little-endian words so the first hit is a count of trailing zeros.
+template <size_t N>
+size_t findStop(const unsigned char* data, size_t from, const size_t size, const StopSet<N>& stops) {
+    for (; from + 16 <= size; from += 16) {
+        Bytes16 chunk;
+        std::memcpy(&chunk, data + from, sizeof(chunk));
+
+        Bytes16 hits = reinterpret_cast<Bytes16>(chunk == stops.splat[0]);
+        for (size_t k = 1; k < stops.count; ++k) hits |= reinterpret_cast<Bytes16>(chunk == stops.splat[k]);
+
+        uint64_t lo, hi;
+        std::memcpy(&lo, &hits, 8);
+        std::memcpy(&hi, reinterpret_cast<const char*>(&hits) + 8, 8);
+        if (lo) return from + static_cast<size_t>(__builtin_ctzll(lo)) / 8;
+        if (hi) return from + 8 + static_cast<size_t>(__builtin_ctzll(hi)) / 8;
+    }
+
+    for (; from < size; ++from) {
+        for (size_t k = 0; k < stops.count; ++k) {
+            if (data[from] == stops.splat[k][0]) return from;
+        }
+    }
+    return size;
+}
+
+Match matchAt(const char* data, const size_t i, const size_t size, const std::string_view marker) {
+    if (marker.empty() || data[i] != marker.front()) return Match::No;
+    if (size - i < marker.size()) {
+        return std::memcmp(data + i, marker.data(), size - i) == 0 ? Match::NeedMore : Match::No;
+    }
+    return std::memcmp(data + i, marker.data(), marker.size()) == 0 ? Match::Yes : Match::No;
+}
+
+}
+
+LineLexer::LineLexer(const CommentSyntax& syntax) : syntax(syntax) {
+    classes['\n'] = kNewline;
+    for (const unsigned char c : {' ', '\t', '\r', '\v', '\f'}) classes[c] = kSpace;
+    for (const auto& marker : syntax.line) {
+        if (!marker.empty()) classes[static_cast<unsigned char>(marker.front())] |= kSpecial;
+    }
+    if (!syntax.blockOpen.empty()) classes[static_cast<unsigned char>(syntax.blockOpen.front())] |= kSpecial;
+    if (!syntax.blockClose.empty()) classes[static_cast<unsigned char>(syntax.blockClose.front())] |= kBlockEnd;
+    for (const unsigned char c : syntax.quotes) classes[c] |= kSpecial | kQuote;
+    classes['\\'] |= kEscape;
+}
+
+void LineLexer::endLine() {
+    ++stats.lines;
+    if (hasCode) ++stats.code;
+    else if (hasComment) ++stats.comment;
+    else ++stats.blank;
+
+    lineOpen = hasCode = hasComment = false;
+    if (state == State::LineComment) state = State::Code;
+}
+
+// Returns how many bytes were consumed. Unless `final` is set it stops early
+// when a marker or escape at the end of the buffer needs bytes it does not have.
+// Every state skips the bytes it does not care about 16 at a time and only
+// stops on newlines, quotes and the first byte of a comment marker.
+size_t LineLexer::scan(const char* data, const size_t size, const bool final) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    StopSet<8> codeStops;
+    codeStops.add('\n');
+    for (const auto& marker : syntax.line) {
+        if (!marker.empty()) codeStops.add(marker.front());
+    }
+    if (!syntax.blockOpen.empty()) codeStops.add(syntax.blockOpen.front());
+    for (const char q : syntax.quotes.substr(0, 4)) codeStops.add(q);
+
+    StopSet<2> blockStops;
+    blockStops.add('\n');
+    if (!syntax.blockClose.empty()) blockStops.add(syntax.blockClose.front());
+
+    size_t i = 0;
+
+    while (i < size) {
+        switch (state) {
+            case State::Code: {
+                size_t j = i;
+                while (j < size && classes[bytes[j]] == kSpace) ++j;
+                if (j < size && !(classes[bytes[j]] & (kNewline | kSpecial))) {
+                    hasCode = true;
+                    j = findStop(bytes, j, size, codeStops);
+                }
+                if (j > i) {
+                    lineOpen = true;
+                    i = j;
+                    if (i == size) return size;
+                }
+
+                const uint8_t cls = classes[bytes[i]];
+                if (cls & kNewline) {
+                    endLine();
+                    ++i;
+                    break;
+                }
+                lineOpen = true;
+
+                bool matched = false;
+                for (const auto& marker : syntax.line) {
+                    const Match m = matchAt(data, i, size, marker);
+                    if (m == Match::NeedMore && !final) return i;
+                    if (m == Match::Yes) {
+                        state = State::LineComment;
+                        hasComment = true;
+                        matched = true;
+                        break;
+                    }
+                }
+                if (matched) break;
+
+                if (const Match m = matchAt(data, i, size, syntax.blockOpen); m != Match::No) {
+                    if (m == Match::NeedMore && !final) return i;
+                    if (m == Match::Yes) {
+                        state = State::BlockComment;
+                        hasComment = true;
+                        i += syntax.blockOpen.size();
+                        break;
+                    }
+                }
+
+                hasCode = true;
+                if (cls & kQuote) {
+                    state = State::String;
+                    quote = data[i];
+                }
+                ++i;
+                break;
+            }
+
+            case State::LineComment: {
+                const void* nl = std::memchr(data + i, '\n', size - i);
+                if (!nl) return size;
+                i = static_cast<size_t>(static_cast<const char*>(nl) - data);
+                endLine();
+                ++i;
+                break;
+            }
+
+            case State::BlockComment: {
+                size_t j = i;
+                while (j < size && classes[bytes[j]] == kSpace) ++j;
+                if (j < size && !(classes[bytes[j]] & (kNewline | kBlockEnd))) {
+                    hasComment = true;
+                    j = findStop(bytes, j, size, blockStops);
+                }
+                if (j > i) {
+                    lineOpen = true;
+                    i = j;
+                    if (i == size) return size;
+                }
+
+                const uint8_t cls = classes[bytes[i]];
+                if (cls & kNewline) {
+                    endLine();
+                    ++i;
+                    break;
+                }
+                lineOpen = true;
+                hasComment = true;
+
+                const Match m = matchAt(data, i, size, syntax.blockClose);
+                if (m == Match::NeedMore && !final) return i;
+                if (m == Match::Yes) {
+                    state = State::Code;
+                    i += syntax.blockClose.size();
+                    break;
+                }
+                ++i;
+                break;
+            }
+
+            case State::String: {
+                StopSet<3> stringStops;
+                stringStops.add('\n');
+                stringStops.add('\\');
+                stringStops.add(quote);
+
+                size_t j = i;
+                while (j < size && classes[bytes[j]] == kSpace) ++j;
+                if (j < size && data[j] != quote && !(classes[bytes[j]] & (kNewline | kEscape))) {
+                    hasCode = true;
+                    j = findStop(bytes, j, size, stringStops);
+                }
+                if (j > i) {
+                    lineOpen = true;
+                    i = j;
+                    if (i == size) return size;
+                }
+
+                const uint8_t cls = classes[bytes[i]];
+                if (cls & kNewline) {
+                    endLine();
+                    ++i;
+                    break;
+                }
+                lineOpen = true;
+                hasCode = true;
+
+                if (cls & kEscape) {
+                    if (i + 1 == size && !final) return i;
+                    i += (i + 1 < size && data[i + 1] != '\n') ? 2 : 1;
+                    break;
+                }
+                if (data[i] == quote) state = State::Code;
+                ++i;
+                break;
+            }
+        }
+    }
+    return size;
+}
+
+void LineLexer::feed(std::string_view chunk) {
+    if (carrySize > 0) {
+        char joined[kMaxCarry * 3];
+        const size_t head = std::min(chunk.size(), sizeof(joined) - carrySize);
+        std::memcpy(joined, carry.data(), carrySize);
+        std::memcpy(joined + carrySize, chunk.data(), head);
+
+        const size_t total = carrySize + head;
+        const size_t consumed = scan(joined, total, false);
+        if (consumed < carrySize) {
+            carrySize = total - consumed;
+            std::memmove(carry.data(), joined + consumed, carrySize);
+            return;
+        }
+        chunk.remove_prefix(consumed - carrySize);
+        carrySize = 0;
+    }
+
+    const size_t consumed = scan(chunk.data(), chunk.size(), false);
+    carrySize = chunk.size() - consumed;
+    std::memcpy(carry.data(), chunk.data() + consumed, carrySize);
+}
+
+LineStats LineLexer::finish() {
+    if (carrySize > 0) {
+        scan(carry.data(), carrySize, true);
+        carrySize = 0;
+    }
+    if (lineOpen) endLine();
+
+    const LineStats result = stats;
+    stats = {};
+    state = State::Code;
+    return result;
+}
+
+LineStats LineLexer::classify(const CommentSyntax& syntax, const std::string_view content) {
+    LineLexer lexer(syntax);
+    lexer.feed(content);
+    return lexer.finish();
+}
@@ -0,0 +1,318 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "Snapshot.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'L', 'I', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kBufferSize = 1 << 20;
+constexpr uint64_t kMaxPath = 1 << 16;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t languages;
+    uint64_t count;
+};
+static_assert(sizeof(SnapshotHeader) == 24);
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+bool writeAll(const int fd, const char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = write(fd, data, size);
+        if (n < 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Files at the root land in ".", everything else in its directory cut to
+// `depth` levels.
+std::string dirKey(const std::string_view path, const size_t depth) {
+    const size_t slash = path.rfind('/');
+    if (slash == std::string_view::npos || depth == 0) return ".";
+
+    const std::string_view dir = path.substr(0, slash);
+    size_t pos = 0;
+    for (size_t level = 0; level < depth; ++level) {
+        pos = dir.find('/', pos);
+        if (pos == std::string_view::npos) return std::string(dir);
+        ++pos;
+    }
+    return std::string(dir.substr(0, pos - 1));
+}
+
+}
+
+// MurmurHash64A. Words are loaded in host byte order, like the cache.
+uint64_t contentHash(const std::string_view data) {
+    constexpr uint64_t m = 0xC6A4A7935BD1E995ull;
+    constexpr int r = 47;
+
+    uint64_t h = 0x9747B28Cull ^ (data.size() * m);
+    const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+    size_t n = data.size();
+
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t k;
+        std::memcpy(&k, p, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    if (n > 0) {
+        for (size_t i = n; i-- > 0;) h ^= static_cast<uint64_t>(p[i]) << (8 * i);
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (fd < 0) return;
+    close(fd);
+    unlink(temp.c_str());
+}
+
+bool SnapshotWriter::fail(const std::string& message) {
+    if (failure.empty()) failure = message;
+    return false;
+}
+
+bool SnapshotWriter::open(const std::string& path, const std::vector<std::string>& languages) {
+    target = path;
+    temp = path + ".tmp." + std::to_string(getpid());
+    fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return fail("cannot create " + temp);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.languages = static_cast<uint32_t>(languages.size());
+
+    buffer.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& name : languages) {
+        putVarint(buffer, name.size());
+        buffer += name;
+    }
+    return true;
+}
+
+bool SnapshotWriter::flush() {
+    if (!writeAll(fd, buffer.data(), buffer.size())) return fail("cannot write " + temp);
+    buffer.clear();
+    return true;
+}
+
+bool SnapshotWriter::add(const SnapshotEntry& entry) {
+    if (fd < 0) return false;
+    if (count > 0 && entry.path <= previous) return fail("snapshot entries out of order: " + entry.path);
+
+    size_t shared = 0;
+    const size_t limit = std::min(previous.size(), entry.path.size());
+    while (shared < limit && previous[shared] == entry.path[shared]) ++shared;
+
+    putVarint(buffer, shared);
+    putVarint(buffer, entry.path.size() - shared);
+    buffer.append(entry.path, shared);
+    putVarint(buffer, entry.lang);
+    putVarint(buffer, entry.stats.lines);
+    putVarint(buffer, entry.stats.code);
+    putVarint(buffer, entry.stats.comment);
+    buffer.append(reinterpret_cast<const char*>(&entry.hash), sizeof(entry.hash));
+
+    previous = entry.path;
+    ++count;
+    return buffer.size() < kBufferSize || flush();
+}
+
+bool SnapshotWriter::finish() {
+    if (fd < 0) return false;
+    bool ok = flush()
+           && pwrite(fd, &count, sizeof(count), offsetof(SnapshotHeader, count)) == sizeof(count);
+    ok = close(fd) == 0 && ok;
+    fd = -1;
+
+    if (!ok || std::rename(temp.c_str(), target.c_str()) != 0) {
+        unlink(temp.c_str());
+        return fail("cannot write " + target);
+    }
+    return true;
+}
+
+SnapshotReader::~SnapshotReader() {
+    if (fd >= 0) close(fd);
+}
+
+bool SnapshotReader::isSnapshot(const std::string& path) {
+    const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+    char magic[sizeof(kMagic)] = {};
+    const bool match = pread(file, magic, sizeof(magic), 0) == sizeof(magic)
+                    && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    close(file);
+    return match;
+}
+
+bool SnapshotReader::fail(const std::string& message) {
+    if (failure.empty()) failure = message;
+    return false;
+}
+
+bool SnapshotReader::fill() {
+    if (begin < end) return true;
+    const ssize_t n = ::read(fd, buffer.data(), buffer.size());
+    if (n <= 0) return false;
+    begin = 0;
+    end = static_cast<size_t>(n);
+    return true;
+}
+
+bool SnapshotReader::readBytes(char* out, size_t size) {
+    while (size > 0) {
+        if (!fill()) return false;
+        const size_t n = std::min(size, end - begin);
+        std::memcpy(out, buffer.data() + begin, n);
+        begin += n;
+        out += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool SnapshotReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (!fill()) return false;
+        const auto byte = static_cast<unsigned char>(buffer[begin++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return fail("cannot open " + path);
+    buffer.resize(kBufferSize);
+
+    SnapshotHeader header{};
+    if (!readBytes(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail(path + " is not a snapshot");
+    }
+    if (header.version != kVersion) return fail(path + " has an unsupported snapshot version");
+
+    names.resize(header.languages);
+    for (auto& name : names) {
+        uint64_t size = 0;
+        if (!readVarint(size) || size > kMaxPath) return fail(path + " is damaged");
+        name.resize(size);
+        if (!readBytes(name.data(), size)) return fail(path + " is damaged");
+    }
+    count = header.count;
+    return true;
+}
+
+bool SnapshotReader::next(SnapshotEntry& entry) {
+    if (consumed == count || !failure.empty()) return false;
+
+    uint64_t shared = 0, rest = 0, lang = 0;
+    uint64_t lines = 0, code = 0, comment = 0;
+    if (!readVarint(shared) || !readVarint(rest) || shared > previous.size() || rest > kMaxPath) {
+        return fail("snapshot is damaged");
+    }
+    previous.resize(shared + rest);
+    if (!readBytes(previous.data() + shared, rest)
+        || !readVarint(lang) || !readVarint(lines) || !readVarint(code) || !readVarint(comment)
+        || !readBytes(reinterpret_cast<char*>(&entry.hash), sizeof(entry.hash))
+        || lang >= names.size() || code + comment > lines) {
+        return fail("snapshot is damaged");
+    }
+
+    entry.path = previous;
+    entry.lang = static_cast<uint32_t>(lang);
+    entry.stats = {lines, code, comment, lines - code - comment};
+    ++consumed;
+    return true;
+}
+
+SnapshotDiff diffSnapshots(const EntrySource& before, const std::vector<std::string>& beforeLangs,
+                           const EntrySource& after, const std::vector<std::string>& afterLangs,
+                           const size_t depth) {
+    SnapshotDiff diff;
+
+    auto apply = [&](const std::string& lang, const std::string_view path, auto&& change) {
+        change(diff.byLang[lang]);
+        change(diff.byDir[dirKey(path, depth)]);
+        change(diff.total);
+    };
+    auto removed = [&](const SnapshotEntry& e) {
+        apply(beforeLangs[e.lang], e.path, [&](LineDelta& d) {
+            ++d.filesRemoved;
+            d.linesRemoved += e.stats.lines;
+        });
+    };
+    auto added = [&](const SnapshotEntry& e) {
+        apply(afterLangs[e.lang], e.path, [&](LineDelta& d) {
+            ++d.filesAdded;
+            d.linesAdded += e.stats.lines;
+        });
+    };
+
+    SnapshotEntry old, now;
+    bool hasOld = before(old);
+    bool hasNow = after(now);
+
+    while (hasOld || hasNow) {
+        const int order = !hasOld ? 1 : !hasNow ? -1 : old.path.compare(now.path);
+        if (order < 0) {
+            removed(old);
+            hasOld = before(old);
+            continue;
+        }
+        if (order > 0) {
+            added(now);
+            hasNow = after(now);
+            continue;
+        }
+
+        if (beforeLangs[old.lang] != afterLangs[now.lang]) {
+            removed(old);
+            added(now);
+        } else if ((old.hash == 0 || now.hash == 0 || old.hash == now.hash) && old.stats.lines == now.stats.lines) {
+            ++diff.unchanged;
+        } else {
+            apply(afterLangs[now.lang], now.path, [&](LineDelta& d) {
+                ++d.filesChanged;
+                if (now.stats.lines > old.stats.lines) d.linesAdded += now.stats.lines - old.stats.lines;
+                else d.linesRemoved += old.stats.lines - now.stats.lines;
+            });
+        }
+        hasOld = before(old);
+        hasNow = after(now);
+    }
+    return diff;
+}
@@ -0,0 +1,250 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "TarReader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace {
+
+constexpr size_t kBlock = 512;
+constexpr size_t kBufferSize = 256 * 1024;
+constexpr uint64_t kMaxMetadata = 1 << 20;
+
+// Octal with optional spaces / NULs, or GNU base-256 when the top bit is set.
+uint64_t parseNumber(const char* field, const size_t size) {
+    uint64_t value = 0;
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+        value = static_cast<unsigned char>(field[0]) & 0x7F;
+        for (size_t i = 1; i < size; ++i) value = value << 8 | static_cast<unsigned char>(field[i]);
+        return value;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        if (field[i] >= '0' && field[i] <= '7') value = value * 8 + static_cast<uint64_t>(field[i] - '0');
+        else if (field[i] != ' ' || value != 0) break;
+    }
+    return value;
+}
+
+bool checksumOk(const char* header) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kBlock; ++i) {
+        sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header[i]);
+    }
+    return sum == parseNumber(header + 148, 8);
+}
+
+std::string field(const char* data, const size_t size) {
+    return std::string(data, strnlen(data, size));
+}
+
+}
+
+TarReader::TarReader() : input(kBufferSize), buffer(kBufferSize) {}
+
+TarReader::~TarReader() {
+    close();
+}
+
+bool TarReader::isArchive(const std::string_view path) {
+    return path.ends_with(".tar") || path.ends_with(".tar.gz") || path.ends_with(".tgz");
+}
+
+void TarReader::close() {
+    if (zs) {
+        inflateEnd(zs);
+        delete zs;
+        zs = nullptr;
+    }
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool TarReader::fail(const std::string& message) {
+    if (failure.empty()) failure = message;
+    return false;
+}
+
+bool TarReader::open(const std::string& path) {
+    close();
+    begin = end = 0;
+    remaining = padding = 0;
+    eof = false;
+    failure.clear();
+
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return fail("cannot open " + path);
+
+    unsigned char magic[2] = {};
+    if (pread(fd, magic, sizeof(magic), 0) == 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        zs = new z_stream{};
+        if (inflateInit2(zs, 16 + MAX_WBITS) != Z_OK) {
+            delete zs;
+            zs = nullptr;
+            return fail("cannot initialise zlib");
+        }
+    }
+    return true;
+}
+
+bool TarReader::fill() {
+    if (begin < end) return true;
+    if (eof) return false;
+    begin = end = 0;
+
+    if (!zs) {
+        const ssize_t n = ::read(fd, buffer.data(), buffer.size());
+        if (n <= 0) {
+            eof = true;
+            return false;
+        }
+        end = static_cast<size_t>(n);
+        return true;
+    }
+
+    while (end == 0) {
+        if (zs->avail_in == 0) {
+            const ssize_t n = ::read(fd, input.data(), input.size());
+            if (n <= 0) {
+                eof = true;
+                return false;
+            }
+            zs->next_in = reinterpret_cast<Bytef*>(input.data());
+            zs->avail_in = static_cast<uInt>(n);
+        }
+
+        zs->next_out = reinterpret_cast<Bytef*>(buffer.data());
+        zs->avail_out = static_cast<uInt>(buffer.size());
+        const int status = inflate(zs, Z_NO_FLUSH);
+        end = buffer.size() - zs->avail_out;
+
+        // `cat a.gz b.gz` is a valid gzip file: start over on the next member.
+        if (status == Z_STREAM_END) {
+            inflateReset(zs);
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            eof = true;
+            return fail("corrupt gzip stream");
+        }
+    }
+    return true;
+}
+
+bool TarReader::readExact(char* out, size_t size) {
+    while (size > 0) {
+        if (!fill()) return false;
+        const size_t n = std::min(size, end - begin);
+        std::memcpy(out, buffer.data() + begin, n);
+        begin += n;
+        out += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool TarReader::skip(uint64_t size) {
+    while (size > 0) {
+        if (!fill()) return false;
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(size, end - begin));
+        begin += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool TarReader::readText(const uint64_t size, std::string& out) {
+    if (size > kMaxMetadata) return fail("oversized tar metadata record");
+    out.resize(size);
+    if (!readExact(out.data(), size)) return false;
+    return skip((kBlock - size % kBlock) % kBlock);
+}
+
+bool TarReader::next(Member& member) {
+    if (!failure.empty()) return false;
+    if (!skip(remaining + padding)) return fail("archive ends inside a member");
+    remaining = padding = 0;
+
+    std::string longName;
+    std::string paxPath;
+    uint64_t paxSize = 0;
+    bool hasPaxSize = false;
+    char header[kBlock];
+
+    while (true) {
+        // A missing end-of-archive marker is common enough to accept.
+        if (!fill()) return false;
+        if (!readExact(header, kBlock)) return fail("archive ends inside a header");
+        if (std::all_of(header, header + kBlock, [](const char c) { return c == 0; })) return false;
+        if (!checksumOk(header)) return fail("not a tar archive (bad header checksum)");
+
+        const char type = header[156];
+        const uint64_t size = parseNumber(header + 124, 12);
+
+        if (type == 'L') {
+            if (!readText(size, longName)) return false;
+            longName.resize(strnlen(longName.data(), longName.size()));
+            continue;
+        }
+        if (type == 'x') {
+            std::string pax;
+            if (!readText(size, pax)) return false;
+            // Records are "<length> <key>=<value>\n".
+            for (size_t pos = 0; pos < pax.size();) {
+                const size_t space = pax.find(' ', pos);
+                if (space == std::string::npos) break;
+                const size_t length = std::strtoull(pax.c_str() + pos, nullptr, 10);
+                if (length == 0 || pos + length > pax.size()) break;
+
+                const std::string_view record(pax.data() + space + 1, pos + length - space - 2);
+                if (record.starts_with("path=")) paxPath = record.substr(5);
+                if (record.starts_with("size=")) {
+                    paxSize = std::strtoull(std::string(record.substr(5)).c_str(), nullptr, 10);
+                    hasPaxSize = true;
+                }
+                pos += length;
+            }
+            continue;
+        }
+
+        const uint64_t contentSize = hasPaxSize ? paxSize : size;
+        if (type != '0' && type != '\0' && type != '7') {
+            if (!skip(contentSize + (kBlock - contentSize % kBlock) % kBlock)) return fail("archive ends inside a member");
+            longName.clear();
+            paxPath.clear();
+            hasPaxSize = false;
+            continue;
+        }
+
+        if (!longName.empty()) {
+            member.path = std::move(longName);
+        } else if (!paxPath.empty()) {
+            member.path = std::move(paxPath);
+        } else {
+            member.path = field(header, 100);
+            const std::string prefix = field(header + 345, 155);
+            // Only POSIX ustar has a prefix; old GNU headers keep times there.
+            if (std::memcmp(header + 257, "ustar\0", 6) == 0 && !prefix.empty()) {
+                member.path = prefix + '/' + member.path;
+            }
+        }
+        while (member.path.starts_with("./")) member.path.erase(0, 2);
+
+        member.size = contentSize;
+        remaining = contentSize;
+        padding = (kBlock - contentSize % kBlock) % kBlock;
+        return true;
+    }
+}
+
+std::string_view TarReader::read() {
+    if (remaining == 0 || !fill()) return {};
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(remaining, end - begin));
+    const std::string_view chunk(buffer.data() + begin, n);
+    begin += n;
+    remaining -= n;
+    return chunk;
+}
@@ -0,0 +1,173 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "TreeRemover.h"
+#include "DirWalk.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+struct Dir {
+    Dir* parent = nullptr;
+    std::string name;
+    uint32_t passes = 0;
+    // Regular files unlinked right in this directory. Only the task listing
+    // it writes these, and passes follow each other, so no atomics needed.
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    uint64_t freed = 0;
+    bool gone = false;
+    std::atomic<bool> stuck{false};     // something inside could not be removed
+    std::atomic<uint32_t> pending{1};   // own listing + subdirectories not removed yet
+};
+
+// readdir() may skip entries while they are being unlinked (it does on
+// some macOS filesystems); a directory left non-empty for no known reason
+// is listed again.
+constexpr uint32_t kMaxPasses = 3;
+
+struct RemoveState {
+    DirWalk<Dir>& walk;
+    const std::atomic<bool>& stop;
+    std::atomic<uint64_t>& files;
+    std::atomic<uint64_t>& dirs;
+    std::atomic<uint64_t>& bytes;
+    std::atomic<uint64_t>& freed;
+    std::atomic<uint64_t>& failed;
+    std::mutex& errorMutex;
+    std::string& error;
+};
+
+void fail(RemoveState& state, const std::string& path, const int err) {
+    state.failed.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard lock(state.errorMutex);
+    if (state.error.empty()) state.error = path + ": " + std::strerror(err);
+}
+
+// `dir` is null when the removal was a single file.
+void countFile(RemoveState& state, Dir* dir, const struct stat& st) {
+    state.files.fetch_add(1, std::memory_order_relaxed);
+    if (!S_ISREG(st.st_mode)) return;
+    const auto size = static_cast<uint64_t>(st.st_size);
+    const uint64_t blocks = st.st_nlink <= 1 ? static_cast<uint64_t>(st.st_blocks) * 512 : 0;
+    state.bytes.fetch_add(size, std::memory_order_relaxed);
+    state.freed.fetch_add(blocks, std::memory_order_relaxed);
+    if (dir) {
+        ++dir->files;
+        dir->bytes += size;
+        dir->freed += blocks;
+    }
+}
+
+// Whoever finishes last under a directory removes it, then does the same
+// one level up. Directories are few next to files, so they go by path and
+// no fd has to outlive its own listing.
+void finish(RemoveState& state, const size_t worker, Dir* dir) {
+    while (dir && dir->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (!state.stop.load(std::memory_order_relaxed)) {
+            const std::string path = state.walk.pathOf(dir);
+            if (unlinkat(AT_FDCWD, path.c_str(), AT_REMOVEDIR) == 0) {
+                dir->gone = true;
+                state.dirs.fetch_add(1, std::memory_order_relaxed);
+            } else if (errno == ENOTEMPTY && !dir->stuck.load(std::memory_order_relaxed) && ++dir->passes < kMaxPasses) {
+                dir->pending.store(1, std::memory_order_relaxed);
+                state.walk.requeue(worker, dir);
+                return;
+            } else {
+                // Not empty because of a failure already reported inside: no second report.
+                if (errno != ENOTEMPTY || !dir->stuck.load(std::memory_order_relaxed)) fail(state, path, errno);
+                if (dir->parent) dir->parent->stuck.store(true, std::memory_order_relaxed);
+            }
+        }
+        dir = dir->parent;
+    }
+}
+
+void emptyDir(RemoveState& state, const size_t worker, Dir* dir, const int fd) {
+    thread_local DirReader reader;
+
+    if (!state.walk.open(reader, dir, fd)) {
+        fail(state, state.walk.pathOf(dir), errno);
+        dir->stuck.store(true, std::memory_order_relaxed);
+    } else {
+        DirReader::Entry entry{};
+        struct stat st{};
+        while (!state.stop.load(std::memory_order_relaxed) && reader.next(entry)) {
+            if (entry.type == DT_DIR) {
+                state.walk.queue(worker, state.walk.emplace(worker, dir, entry.name), reader.fd());
+                continue;
+            }
+            if (!statAt(reader.fd(), entry.name.data(), st)) continue;
+            if (S_ISDIR(st.st_mode)) {
+                state.walk.queue(worker, state.walk.emplace(worker, dir, entry.name), reader.fd());
+                continue;
+            }
+
+            if (unlinkat(reader.fd(), entry.name.data(), 0) == 0) {
+                countFile(state, dir, st);
+            } else {
+                fail(state, state.walk.pathOf(dir) + '/' + std::string(entry.name), errno);
+                dir->stuck.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (reader.failed()) {
+            fail(state, state.walk.pathOf(dir), errno);
+            dir->stuck.store(true, std::memory_order_relaxed);
+        }
+        reader.close();
+    }
+    finish(state, worker, dir);
+}
+
+}
+
+TreeRemover::~TreeRemover() {
+    cancel();
+    wait();
+}
+
+void TreeRemover::start(const std::string& path, const size_t threads) {
+    runner = std::thread([this, path, threads] { run(path, threads); });
+}
+
+void TreeRemover::wait() {
+    if (runner.joinable()) runner.join();
+}
+
+std::string TreeRemover::firstError() const {
+    std::lock_guard lock(errorMutex);
+    return error;
+}
+
+void TreeRemover::run(const std::string& path, const size_t threads) {
+    DirWalk<Dir> walk(path, threads);
+    RemoveState state{walk, stop, files, dirs, bytes, freed, failed, errorMutex, error};
+
+    struct stat st{};
+    if (lstat(path.c_str(), &st) != 0) {
+        if (errno != ENOENT) fail(state, path, errno);
+    } else if (!S_ISDIR(st.st_mode)) {
+        if (unlink(path.c_str()) == 0) countFile(state, nullptr, st);
+        else fail(state, path, errno);
+    } else if (const int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC); fd < 0) {
+        fail(state, path, errno);
+    } else {
+        Dir top;
+        walk.run(top, fd, [&](const size_t worker, Dir* dir, const int dirFd) { emptyDir(state, worker, dir, dirFd); });
+
+        auto report = [&](const Dir& dir) {
+            if (dir.files > 0 || dir.gone) touched.push_back({walk.pathOf(&dir), dir.files, dir.bytes, dir.freed, dir.gone});
+        };
+        report(top);
+        for (const auto& arena : walk.nodes()) {
+            for (const auto& dir : arena) report(dir);
+        }
+    }
+
+    gone = lstat(path.c_str(), &st) != 0 && errno == ENOENT;
+    done.store(true, std::memory_order_release);
+}
@@ -0,0 +1,163 @@
+//
+// Created by Marat on 18.10.26.
+//
+
+#include "TreeWatcher.h"
+#include <chrono>
+#include <filesystem>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr uint32_t kEvents = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                           | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+
+// A file that is rewritten without pause would otherwise hold a batch open
+// forever.
+constexpr auto kMaxBatch = std::chrono::seconds(2);
+
+std::string join(const std::string& dir, const std::string_view name) {
+    return dir.empty() ? std::string(name) : dir + '/' + std::string(name);
+}
+
+}
+
+TreeWatcher::~TreeWatcher() {
+    if (fd >= 0) close(fd);
+}
+
+bool TreeWatcher::start(const std::string& rootPath, DirFilter filter) {
+    root = rootPath;
+    skip = std::move(filter);
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+
+    addTree("");
+    return !dirs.empty();
+}
+
+void TreeWatcher::addTree(const std::string& relDir) {
+    std::vector<std::string> stack = {relDir};
+
+    while (!stack.empty()) {
+        const std::string rel = std::move(stack.back());
+        stack.pop_back();
+
+        const std::string path = rel.empty() ? root : root + '/' + rel;
+        const int wd = inotify_add_watch(fd, path.c_str(), kEvents);
+        if (wd < 0) {
+            // ENOSPC: fs.inotify.max_user_watches is used up.
+            ++failures;
+            continue;
+        }
+        dirs[wd] = rel;
+
+        std::error_code ec;
+        fs::directory_iterator it(path, fs::directory_options::skip_permission_denied, ec);
+        for (const fs::directory_iterator end; !ec && it != end; it.increment(ec)) {
+            std::error_code typeEc;
+            if (it->is_symlink(typeEc) || !it->is_directory(typeEc)) continue;
+
+            std::string child = join(rel, it->path().filename().native());
+            if (!skip(child)) stack.push_back(std::move(child));
+        }
+    }
+}
+
+void TreeWatcher::dropTree(const std::string& relDir) {
+    const std::string prefix = relDir + '/';
+    for (auto it = dirs.begin(); it != dirs.end();) {
+        if (it->second == relDir || it->second.starts_with(prefix)) {
+            inotify_rm_watch(fd, it->first);
+            it = dirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+TreeWatcher::Changes TreeWatcher::poll(const int timeoutMs, const int settleMs) {
+    Changes changes;
+    if (fd < 0) return changes;
+
+    std::unordered_set<std::string> files;
+    std::unordered_set<std::string> subtrees;
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    const auto started = std::chrono::steady_clock::now();
+    int wait = timeoutMs;
+
+    while (std::chrono::steady_clock::now() - started < kMaxBatch) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, wait) <= 0) break;
+        wait = settleMs;
+
+        while (true) {
+            const ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n <= 0) break;
+
+            for (ssize_t pos = 0; pos < n;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + pos);
+                pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    changes.overflow = true;
+                    continue;
+                }
+
+                const auto dir = dirs.find(event->wd);
+                if (dir == dirs.end()) continue;
+                if (event->mask & IN_IGNORED) {
+                    dirs.erase(dir);
+                    continue;
+                }
+                if (event->len == 0) continue;
+
+                const std::string rel = join(dir->second, event->name);
+                if (!(event->mask & IN_ISDIR)) {
+                    files.insert(rel);
+                } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if (skip(rel)) continue;
+                    addTree(rel);
+                    subtrees.insert(rel);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    dropTree(rel);
+                    subtrees.insert(rel);
+                }
+            }
+        }
+    }
+
+    changes.files.assign(files.begin(), files.end());
+    changes.dirs.assign(subtrees.begin(), subtrees.end());
+    return changes;
+}
+
+#else
+
+TreeWatcher::~TreeWatcher() = default;
+
+bool TreeWatcher::start(const std::string& rootPath, DirFilter filter) {
+    root = rootPath;
+    skip = std::move(filter);
+    return false;
+}
+
+void TreeWatcher::addTree(const std::string&) {}
+void TreeWatcher::dropTree(const std::string&) {}
+
+TreeWatcher::Changes TreeWatcher::poll(int, int) {
+    return {};
+}
+
+#endif
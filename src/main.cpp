@@ -129,7 +129,7 @@ int main(const int argc, const char* argv[]) {
         }
         const std::vector<std::string> args(argv + 2, argv + argc);
         it->second->execute(args);
-        return 0;
+        return it->second->exitCode();
     }
 
     while (g_running) {